@@ -9,18 +9,25 @@
 #include "compiler/backend.h"
 #include "compiler/compiler.h"
 #include "compiler/log/debug.h"
+#include "compiler/native/pir_jit_llvm.h"
 #include "compiler/parameter.h"
 #include "compiler/pir/closure.h"
 #include "compiler/test/PirCheck.h"
 #include "compiler/test/PirTests.h"
 #include "interpreter/interp_incl.h"
+#include "runtime/CodeBudget.h"
+#include "utils/JitStats.h"
 #include "utils/measuring.h"
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstdio>
 #include <list>
 #include <memory>
+#include <sstream>
 #include <string>
+#include <unordered_map>
 
 using namespace rir;
 
@@ -296,6 +303,7 @@ SEXP pirCompile(SEXP what, const Context& assumptions, const std::string& name,
     }
 
     PROTECT(what);
+    auto start = std::chrono::steady_clock::now();
 
     bool dryRun = debug.includes(pir::DebugFlag::DryRun);
     // compile to pir
@@ -354,10 +362,15 @@ SEXP pirCompile(SEXP what, const Context& assumptions, const std::string& name,
 
     cmp.compileClosure(what, name, assumptions, true, compile,
                        [&]() {
+                           JitStats::compilationsFailed++;
                            if (debug.includes(pir::DebugFlag::ShowWarnings))
                                std::cerr << "Compilation failed\n";
                        },
                        {});
+    JitStats::compilations++;
+    JitStats::compileTime += std::chrono::duration<double>(
+                                 std::chrono::steady_clock::now() - start)
+                                 .count();
 
     delete m;
     UNPROTECT(1);
@@ -536,6 +549,132 @@ REXPORT SEXP rirResetMeasuring(SEXP outputOld) {
     return R_NilValue;
 }
 
+REXPORT SEXP rirSetCodeBudget(SEXP bytes) {
+    auto b = Rf_asReal(bytes);
+    if (ISNAN(b) || b < 0)
+        Rf_error("budget must be a non-negative number of bytes");
+    CodeBudget::budget((size_t)b);
+    return R_NilValue;
+}
+
+static SEXP namedReal(
+    std::initializer_list<std::pair<const char*, double>> values) {
+    auto res = PROTECT(Rf_allocVector(REALSXP, values.size()));
+    auto names = PROTECT(Rf_allocVector(STRSXP, values.size()));
+    size_t i = 0;
+    for (auto& v : values) {
+        REAL(res)[i] = v.second;
+        SET_STRING_ELT(names, i++, Rf_mkChar(v.first));
+    }
+    Rf_setAttrib(res, R_NamesSymbol, names);
+    UNPROTECT(2);
+    return res;
+}
+
+REXPORT SEXP rirCodeBudget() {
+    return namedReal({{"budget", CodeBudget::budget()},
+                      {"usage", CodeBudget::usage()},
+                      {"nativeBytes", pir::PirJitLLVM::liveNativeCodeBytes()},
+                      {"objectBytes", CodeBudget::objectBytes()},
+                      {"versions", CodeBudget::versions()},
+                      {"evicted", CodeBudget::evicted()}});
+}
+
+static SEXP functionStats(SEXP what) {
+    if (!isValidClosureSEXP(what))
+        Rf_error("not a compiled closure");
+    auto dt = DispatchTable::unpack(BODY(what));
+    auto n = dt->size();
+    auto context = PROTECT(Rf_allocVector(STRSXP, n));
+    auto optimized = PROTECT(Rf_allocVector(LGLSXP, n));
+    auto invocations = PROTECT(Rf_allocVector(REALSXP, n));
+    auto deopts = PROTECT(Rf_allocVector(REALSXP, n));
+    auto disabled = PROTECT(Rf_allocVector(LGLSXP, n));
+    auto bytes = PROTECT(Rf_allocVector(REALSXP, n));
+    for (size_t i = 0; i < n; ++i) {
+        auto fun = dt->get(i);
+        std::stringstream ctx;
+        ctx << fun->context();
+        SET_STRING_ELT(context, i, Rf_mkChar(ctx.str().c_str()));
+        LOGICAL(optimized)[i] = fun->isOptimized();
+        REAL(invocations)[i] = fun->invocationCount();
+        REAL(deopts)[i] = fun->deoptCount();
+        LOGICAL(disabled)[i] = fun->disabled();
+        REAL(bytes)[i] = CodeBudget::footprint(fun);
+    }
+    auto res = PROTECT(Rf_allocVector(VECSXP, 6));
+    auto names = PROTECT(Rf_allocVector(STRSXP, 6));
+    int i = 0;
+    for (auto& col : {std::make_pair("context", context),
+                      std::make_pair("optimized", optimized),
+                      std::make_pair("invocations", invocations),
+                      std::make_pair("deopts", deopts),
+                      std::make_pair("disabled", disabled),
+                      std::make_pair("bytes", bytes)}) {
+        SET_VECTOR_ELT(res, i, col.second);
+        SET_STRING_ELT(names, i++, Rf_mkChar(col.first));
+    }
+    Rf_setAttrib(res, R_NamesSymbol, names);
+    UNPROTECT(8);
+    return res;
+}
+
+REXPORT SEXP rirStats(SEXP what) {
+    if (what != R_NilValue)
+        return functionStats(what);
+
+    auto deopts = PROTECT(Rf_allocVector(REALSXP, JitStats::NumDeoptReasons));
+    auto reasons =
+        PROTECT(Rf_allocVector(STRSXP, JitStats::NumDeoptReasons));
+    for (size_t i = 0; i < JitStats::NumDeoptReasons; ++i) {
+        REAL(deopts)[i] = JitStats::deopts[i];
+        SET_STRING_ELT(reasons, i, Rf_mkChar(JitStats::deoptReasonName(i)));
+    }
+    Rf_setAttrib(deopts, R_NamesSymbol, reasons);
+
+    size_t tables = 0, maxVersions = 0;
+    std::unordered_map<DispatchTable*, size_t> versions;
+    CodeBudget::eachVersion(
+        [&](DispatchTable* dt, Function*) { versions[dt]++; });
+    for (auto& v : versions) {
+        tables++;
+        maxVersions = std::max(maxVersions, v.second);
+    }
+
+#ifdef RIR_OPCODE_STATS
+    double hits = JitStats::bindingCacheHits;
+    double misses = JitStats::bindingCacheMisses;
+    double hitRate = hits + misses > 0 ? hits / (hits + misses) : NA_REAL;
+#else
+    // Binding cache lookups are not counted in this build
+    double hits = NA_REAL, misses = NA_REAL, hitRate = NA_REAL;
+#endif
+    auto res = PROTECT(Rf_allocVector(VECSXP, 8));
+    auto names = PROTECT(Rf_allocVector(STRSXP, 8));
+    int i = 0;
+    auto add = [&](const char* name, SEXP value) {
+        SET_VECTOR_ELT(res, i, value);
+        SET_STRING_ELT(names, i++, Rf_mkChar(name));
+    };
+    add("compilations", namedReal({{"total", JitStats::compilations},
+                                   {"failed", JitStats::compilationsFailed}}));
+    add("compileTime", Rf_ScalarReal(JitStats::compileTime));
+    add("deopts", deopts);
+    add("osrEntries", Rf_ScalarReal(JitStats::osrEntries));
+    add("deoptlessHits", Rf_ScalarReal(JitStats::deoptlessHits));
+    add("nativeCode",
+        namedReal({{"bytes", pir::PirJitLLVM::liveNativeCodeBytes()},
+                   {"modules", pir::PirJitLLVM::liveModules()}}));
+    add("dispatchTables", namedReal({{"tables", tables},
+                                     {"versions", CodeBudget::versions()},
+                                     {"maxVersions", maxVersions}}));
+    add("bindingCache",
+        namedReal({{"hits", hits}, {"misses", misses}, {"hitRate", hitRate}}));
+    Rf_setAttrib(res, R_NamesSymbol, names);
+    UNPROTECT(4);
+    return res;
+}
+
 REXPORT SEXP rirPrintBuiltinIds() {
     FUNTAB* finger = R_FunTab;
     int i = 0;
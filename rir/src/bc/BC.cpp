@@ -99,6 +99,9 @@ void BC::write(CodeStream& cs) const {
         cs.insert(immediate.i);
         return;
 
+#define V(quick, generic) case Opcode::quick:
+        BC_QUICKENED(V)
+#undef V
     case Opcode::invalid_:
     case Opcode::num_of:
         assert(false);
@@ -192,6 +195,9 @@ void BC::deserialize(SEXP refTable, R_inpstream_t inp, Opcode* code,
             assert((size - 1) % 4 == 0);
             InBytes(inp, code + 1, size - 1);
             break;
+#define V(quick, generic) case Opcode::quick:
+            BC_QUICKENED(V)
+#undef V
         case Opcode::invalid_:
         case Opcode::num_of:
             assert(false);
@@ -215,10 +221,11 @@ void BC::serialize(SEXP refTable, R_outpstream_t out, const Opcode* code,
                    size_t codeSize, const Code* container) {
     while (codeSize > 0) {
         const BC bc = BC::decode((Opcode*)code, container);
-        OutChar(out, (int)*code);
-        unsigned size = BC::fixedSize(*code);
+        // Quickened instructions are always written as the generic one
+        OutChar(out, (int)bc.bc);
+        unsigned size = BC::fixedSize(bc.bc);
         ImmediateArguments i = bc.immediate;
-        switch (*code) {
+        switch (bc.bc) {
 #define V(NESTED, name, name_) case Opcode::name_##_:
             BC_NOARGS(V, _)
 #undef V
@@ -284,6 +291,9 @@ void BC::serialize(SEXP refTable, R_outpstream_t out, const Opcode* code,
             if (size != 0)
                 OutBytes(out, code + 1, size - 1);
             break;
+#define V(quick, generic) case Opcode::quick:
+            BC_QUICKENED(V)
+#undef V
         case Opcode::invalid_:
         case Opcode::num_of:
             assert(false);
@@ -336,6 +346,9 @@ void BC::print(std::ostream& out) const {
         printOpcode(out);
 
     switch (bc) {
+#define V(quick, generic) case Opcode::quick:
+        BC_QUICKENED(V)
+#undef V
     case Opcode::invalid_:
     case Opcode::num_of:
         assert(false);
@@ -3,6 +3,7 @@
 
 #include "R/r.h"
 #include "bc/BC_noarg_list.h"
+#include "bc/BC_quickened_list.h"
 #include "common.h"
 #include "compiler/pir/type.h"
 #include "runtime/Context.h"
@@ -295,6 +296,21 @@ class BC {
 
     inline static Opcode* next(rir::Opcode* pc) { return pc + size(pc); }
 
+    // The interpreter rewrites some instructions in place into quickened
+    // variants (see BC_quickened_list.h). This maps them back to the generic
+    // instruction, which is all the rest of the system needs to know about.
+    static Opcode dequicken(Opcode bc) {
+        switch (bc) {
+#define V(quick, generic)                                                      \
+    case Opcode::quick:                                                        \
+        return Opcode::generic;
+            BC_QUICKENED(V)
+#undef V
+        default:
+            return bc;
+        }
+    }
+
     // If the decoded BC is not needed, you should use next, since it is much
     // faster.
     inline static BC advance(Opcode** pc, Code* code)
@@ -468,7 +484,7 @@ class BC {
     }
 
     inline void decodeFixlen(Opcode* pc) {
-        bc = *pc;
+        bc = dequicken(*pc);
         pc++;
         immediate = decodeImmediateArguments(bc, pc);
     }
@@ -597,6 +613,9 @@ class BC {
             BC_NOARGS(V, _)
 #undef V
             break;
+#define V(quick, generic) case Opcode::quick:
+            BC_QUICKENED(V)
+#undef V
         case Opcode::invalid_:
         case Opcode::num_of:
             assert(false);
@@ -0,0 +1,26 @@
+#ifndef BC_QUICKENED_LIST_H
+#define BC_QUICKENED_LIST_H
+
+// V(quickened, generic)
+#define BC_QUICKENED(V)                                                        \
+    V(add_int_, add_)                                                          \
+    V(add_real_, add_)                                                         \
+    V(sub_int_, sub_)                                                          \
+    V(sub_real_, sub_)                                                         \
+    V(mul_int_, mul_)                                                          \
+    V(mul_real_, mul_)                                                         \
+    V(eq_int_, eq_)                                                            \
+    V(eq_real_, eq_)                                                           \
+    V(ne_int_, ne_)                                                            \
+    V(ne_real_, ne_)                                                           \
+    V(lt_int_, lt_)                                                            \
+    V(lt_real_, lt_)                                                           \
+    V(le_int_, le_)                                                            \
+    V(le_real_, le_)                                                           \
+    V(gt_int_, gt_)                                                            \
+    V(gt_real_, gt_)                                                           \
+    V(ge_int_, ge_)                                                            \
+    V(ge_real_, ge_)                                                           \
+    V(push_binop_, push_)
+
+#endif
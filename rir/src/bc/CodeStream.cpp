@@ -0,0 +1,207 @@
+#include "bc/CodeStream.h"
+#include "utils/Pool.h"
+
+#include <climits>
+#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace rir {
+
+static bool isScalarNumber(SEXP c) {
+    return (TYPEOF(c) == REALSXP || TYPEOF(c) == INTSXP) &&
+           XLENGTH(c) == 1 && ATTRIB(c) == R_NilValue;
+}
+
+// Doubles are only folded if the result cannot be confused in the constant
+// pool, which keys numbers by value: this excludes NA, NaN and signed zeros.
+static bool foldedReal(double res, BC::PoolIdx& idx) {
+    if (std::isnan(res) || res == 0)
+        return false;
+    idx = Pool::getNum(res);
+    return true;
+}
+
+static bool foldedInt(long long res, BC::PoolIdx& idx) {
+    // INT_MIN is NA_INTEGER, R produces NA with a warning on overflow
+    if (res <= INT_MIN || res > INT_MAX)
+        return false;
+    idx = Pool::getInt((int)res);
+    return true;
+}
+
+static bool foldUnop(Opcode op, SEXP a, BC::PoolIdx& idx) {
+    if (op != Opcode::uminus_ || !isScalarNumber(a))
+        return false;
+    if (TYPEOF(a) == INTSXP)
+        return INTEGER(a)[0] != NA_INTEGER &&
+               foldedInt(-(long long)INTEGER(a)[0], idx);
+    return foldedReal(-REAL(a)[0], idx);
+}
+
+static bool foldBinop(Opcode op, SEXP a, SEXP b, BC::PoolIdx& idx) {
+    if (!isScalarNumber(a) || !isScalarNumber(b))
+        return false;
+    if ((TYPEOF(a) == INTSXP && INTEGER(a)[0] == NA_INTEGER) ||
+        (TYPEOF(b) == INTSXP && INTEGER(b)[0] == NA_INTEGER))
+        return false;
+
+    if (TYPEOF(a) == INTSXP && TYPEOF(b) == INTSXP) {
+        long long x = INTEGER(a)[0], y = INTEGER(b)[0];
+        switch (op) {
+        case Opcode::add_:
+            return foldedInt(x + y, idx);
+        case Opcode::sub_:
+            return foldedInt(x - y, idx);
+        case Opcode::mul_:
+            return foldedInt(x * y, idx);
+        case Opcode::div_:
+            return foldedReal((double)x / (double)y, idx);
+        default:
+            return false;
+        }
+    }
+
+    double x = TYPEOF(a) == INTSXP ? INTEGER(a)[0] : REAL(a)[0];
+    double y = TYPEOF(b) == INTSXP ? INTEGER(b)[0] : REAL(b)[0];
+    switch (op) {
+    case Opcode::add_:
+        return foldedReal(x + y, idx);
+    case Opcode::sub_:
+        return foldedReal(x - y, idx);
+    case Opcode::mul_:
+        return foldedReal(x * y, idx);
+    case Opcode::div_:
+        return foldedReal(x / y, idx);
+    default:
+        return false;
+    }
+}
+
+void CodeStream::peephole() {
+    // Is there a label in (from, to]? If so, an instruction in between is a
+    // jump target and the sequence cannot be merged.
+    auto labelIn = [&](PcOffset from, PcOffset to) {
+        auto l = labels.upper_bound(from);
+        return l != labels.end() && l->first <= to;
+    };
+    auto immediatePool = [&](PcOffset pc) {
+        return BC::decodeShallow(INS(pc)).immediate.pool;
+    };
+    auto setImmediatePool = [&](PcOffset pc, BC::PoolIdx idx) {
+        memcpy(&(*code)[pc + sizeof(Opcode)], &idx, sizeof(BC::PoolIdx));
+    };
+
+    // Folding is only sound because the compiler emits the guard_fun_ for
+    // `+` and friends in front of the first operand, thus the guard stays in
+    // place and still fails if the operator is redefined.
+    bool changed = true;
+    while (changed) {
+        changed = false;
+
+        std::vector<PcOffset> insns;
+        for (PcOffset pc = 0; pc < pos; pc += BC::size(INS(pc)))
+            if (*INS(pc) != Opcode::nop_)
+                insns.push_back(pc);
+
+        for (size_t i = 0; i + 1 < insns.size(); ++i) {
+            auto a = insns[i];
+            auto b = insns[i + 1];
+            if (labelIn(a, b))
+                continue;
+            auto opA = *INS(a);
+            auto opB = *INS(b);
+
+            // push_ c; pop_  and  dup_; pop_
+            if ((opA == Opcode::push_ || opA == Opcode::dup_) &&
+                opB == Opcode::pop_) {
+                remove(a);
+                remove(b);
+                changed = true;
+                i++;
+                continue;
+            }
+
+            if (opA != Opcode::push_)
+                continue;
+
+            // push_ c; uminus_
+            BC::PoolIdx res;
+            if (foldUnop(opB, Pool::get(immediatePool(a)), res)) {
+                setImmediatePool(a, res);
+                remove(b);
+                changed = true;
+                i++;
+                continue;
+            }
+
+            // push_ c1; push_ c2; add_
+            if (opB != Opcode::push_ || i + 2 >= insns.size())
+                continue;
+            auto c = insns[i + 2];
+            if (labelIn(b, c))
+                continue;
+            if (foldBinop(*INS(c), Pool::get(immediatePool(a)),
+                          Pool::get(immediatePool(b)), res)) {
+                setImmediatePool(a, res);
+                remove(b);
+                remove(c);
+                changed = true;
+                i += 2;
+            }
+        }
+    }
+
+    // Thread jumps which land on an unconditional jump to the final target.
+    // An unconditional jump to a return is replaced by the return itself.
+    std::unordered_map<BC::Label, PcOffset> labelPos;
+    for (auto& l : labels)
+        for (auto n : l.second)
+            labelPos[n] = l.first;
+    auto target = [&](BC::Label l) {
+        PcOffset pc = labelPos.at(l);
+        while (pc < pos && *INS(pc) == Opcode::nop_)
+            pc++;
+        return pc;
+    };
+
+    for (PcOffset pc = 0; pc < pos; pc += BC::size(INS(pc))) {
+        auto op = *INS(pc);
+        auto imm = pc + sizeof(Opcode);
+        if ((op != Opcode::br_ && op != Opcode::brtrue_ &&
+             op != Opcode::brfalse_) ||
+            !patchpoints.count(imm) || !labelPos.count(patchpoints.at(imm)))
+            continue;
+
+        auto label = patchpoints.at(imm);
+        std::unordered_set<BC::Label> seen = {label};
+        while (true) {
+            auto t = target(label);
+            if (t >= pos || *INS(t) != Opcode::br_ ||
+                !patchpoints.count(t + sizeof(Opcode)))
+                break;
+            auto next = patchpoints.at(t + sizeof(Opcode));
+            if (seen.count(next) || !labelPos.count(next))
+                break;
+            seen.insert(next);
+            label = next;
+        }
+
+        auto t = target(label);
+        if (op == Opcode::br_ && t < pos &&
+            (*INS(t) == Opcode::ret_ || *INS(t) == Opcode::return_)) {
+            auto bcSize = BC::size(INS(pc));
+            sources.erase(pc + bcSize);
+            patchpoints.erase(imm);
+            *INS(pc) = *INS(t);
+            for (unsigned j = 1; j < bcSize; ++j) {
+                *INS(pc + j) = Opcode::nop_;
+                nops++;
+            }
+            continue;
+        }
+        patchpoints[imm] = label;
+    }
+}
+
+} // namespace rir
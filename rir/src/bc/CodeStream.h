@@ -143,6 +143,13 @@ class CodeStream {
         sources.erase(pc + bcSize);
     }
 
+    // Local cleanup of the emitted bytecode before it is written out: folds
+    // arithmetic on scalar constants, drops values which are pushed only to be
+    // popped again and threads jumps to jumps. Instructions are only replaced
+    // by nops (or shorter instructions padded with nops), thus positions of
+    // labels, patchpoints and sources stay valid.
+    void peephole();
+
     Code* finalize(size_t localsCnt, size_t bindingsCnt) {
         Code* res =
             function.writeCode(ast, &(*code)[0], pos, sources, patchpoints,
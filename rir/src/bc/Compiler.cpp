@@ -183,6 +183,8 @@ class CompilerContext {
     }
 
     Code* pop() {
+        if (Compiler::peepholeEnabled)
+            cs().peephole();
         Code* res = cs().finalize(0, code.top()->loadsSlotInCache.size());
         if (code.top()->isPromiseContext())
             pushedPromiseContexts--;
@@ -1763,10 +1765,7 @@ static void compileLoadOneArg(CompilerContext& ctx, SEXP arg, ArgType arg_type,
             res.assumptions.setEager(i);
             if (!Rf_isObject(eager)) {
                 res.assumptions.setNotObj(i);
-                if (IS_SIMPLE_SCALAR(eager, REALSXP))
-                    res.assumptions.setSimpleReal(i);
-                if (IS_SIMPLE_SCALAR(eager, INTSXP))
-                    res.assumptions.setSimpleInt(i);
+                res.assumptions.setValueShape(i, eager);
             }
             cs << BC::push(eager);
             return;
@@ -2071,4 +2070,8 @@ bool Compiler::profile =
 
 bool Compiler::loopPeelingEnabled = true;
 
+bool Compiler::peepholeEnabled =
+    !(getenv("RIR_PEEPHOLE") &&
+      std::string(getenv("RIR_PEEPHOLE")).compare("off") == 0);
+
 } // namespace rir
@@ -41,6 +41,7 @@ class Compiler {
     static bool profile;
     static bool unsoundOpts;
     static bool loopPeelingEnabled;
+    static bool peepholeEnabled;
 
     static SEXP compileExpression(SEXP ast) {
         Compiler c(ast);
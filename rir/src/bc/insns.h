@@ -449,4 +449,40 @@ DEF_INSTR(record_test_, 1, 1, 1)
 
 DEF_INSTR(int3_, 0, 0, 0)
 
+/*
+ * Quickened bytecodes. The interpreter rewrites the generic instruction in
+ * place into one of these, once it has seen simple scalar operands of the
+ * given type. If the operands do not match, the instruction rewrites itself
+ * back to the generic version. They have the same size and stack effect as
+ * the generic one and are only ever seen by the interpreter: BC::decode and
+ * serialization map them back to the generic instruction (see
+ * BC_quickened_list.h).
+ */
+DEF_INSTR(add_int_, 0, 2, 1)
+DEF_INSTR(add_real_, 0, 2, 1)
+DEF_INSTR(sub_int_, 0, 2, 1)
+DEF_INSTR(sub_real_, 0, 2, 1)
+DEF_INSTR(mul_int_, 0, 2, 1)
+DEF_INSTR(mul_real_, 0, 2, 1)
+DEF_INSTR(eq_int_, 0, 2, 1)
+DEF_INSTR(eq_real_, 0, 2, 1)
+DEF_INSTR(ne_int_, 0, 2, 1)
+DEF_INSTR(ne_real_, 0, 2, 1)
+DEF_INSTR(lt_int_, 0, 2, 1)
+DEF_INSTR(lt_real_, 0, 2, 1)
+DEF_INSTR(le_int_, 0, 2, 1)
+DEF_INSTR(le_real_, 0, 2, 1)
+DEF_INSTR(gt_int_, 0, 2, 1)
+DEF_INSTR(gt_real_, 0, 2, 1)
+DEF_INSTR(ge_int_, 0, 2, 1)
+DEF_INSTR(ge_real_, 0, 2, 1)
+
+/*
+ * push_binop_:: superinstruction replacing a push_ of a scalar constant which
+ * is directly followed by one of the arithmetic or relational instructions
+ * above. Executes both and skips the following instruction. The following
+ * instruction is left intact, so jumping to it is still valid.
+ */
+DEF_INSTR(push_binop_, 1, 0, 1)
+
 #undef DEF_INSTR
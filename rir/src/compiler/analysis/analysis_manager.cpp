@@ -0,0 +1,111 @@
+#include "analysis_manager.h"
+#include "../pir/pir_impl.h"
+#include "scope.h"
+
+#include <functional>
+
+namespace rir {
+namespace pir {
+
+AnalysisManager::AnalysisManager() {}
+AnalysisManager::~AnalysisManager() {}
+
+static void computeShape(Code* code, bool withInstructions,
+                         std::vector<size_t>& shape) {
+    shape.clear();
+    shape.push_back(code->nextBBId);
+    ReversePostOrder rpo(code);
+    for (auto bb : rpo.order()) {
+        shape.push_back((uintptr_t)bb);
+        shape.push_back(bb->id);
+        for (auto n : bb->successors())
+            shape.push_back(n->id);
+        shape.push_back((size_t)-1);
+        if (withInstructions) {
+            for (auto i : *bb)
+                shape.push_back((uintptr_t)i);
+            shape.push_back((size_t)-1);
+        }
+    }
+}
+
+AnalysisManager::CFGResults& AnalysisManager::cfgResultsFor(Code* code) {
+    auto& res = cfgResults[code];
+    if (res.validatedIn == passRun)
+        return res;
+    res.validatedIn = passRun;
+    Shape shape;
+    computeShape(code, false, shape);
+    if (res.shape != shape) {
+        res.shape = std::move(shape);
+        res.cfg.reset();
+        res.dom.reset();
+        res.dfront.reset();
+    }
+    return res;
+}
+
+const CFG& AnalysisManager::cfg(Code* code) {
+    auto& res = cfgResultsFor(code);
+    if (!res.cfg)
+        res.cfg.reset(new CFG(code));
+    return *res.cfg;
+}
+
+const DominanceGraph& AnalysisManager::dominance(Code* code) {
+    auto& res = cfgResultsFor(code);
+    if (!res.dom)
+        res.dom.reset(new DominanceGraph(code));
+    return *res.dom;
+}
+
+const DominanceFrontier& AnalysisManager::dominanceFrontier(Code* code) {
+    auto& res = cfgResultsFor(code);
+    if (!res.dom)
+        res.dom.reset(new DominanceGraph(code));
+    if (!res.dfront)
+        res.dfront.reset(new DominanceFrontier(code, *res.dom));
+    return *res.dfront;
+}
+
+ScopeAnalysis& AnalysisManager::scope(ClosureVersion* cls, Code* code,
+                                      AbstractLog& log) {
+    auto& res = scopeResults[code];
+    if (res.analysis && res.cls == cls && res.validatedIn == passRun)
+        return *res.analysis;
+    res.validatedIn = passRun;
+    Shape instructions;
+    computeShape(code, true, instructions);
+    if (!res.analysis || res.cls != cls || res.instructions != instructions) {
+        res.cls = cls;
+        res.instructions = std::move(instructions);
+        res.analysis.reset(new ScopeAnalysis(cls, code, log));
+        (*res.analysis)();
+    }
+    return *res.analysis;
+}
+
+void AnalysisManager::invalidate(ClosureVersion* cls) {
+    cfgResults.erase(cls);
+    cls->eachPromise([&](Promise* p) { cfgResults.erase(p); });
+
+    for (auto it = scopeResults.begin(); it != scopeResults.end();) {
+        bool depends = false;
+        it->second.analysis->eachDependency([&](ClosureVersion* v) {
+            if (v == cls)
+                depends = true;
+        });
+        if (it->second.cls == cls || depends)
+            it = scopeResults.erase(it);
+        else
+            ++it;
+    }
+}
+
+void AnalysisManager::invalidateAll() {
+    cfgResults.clear();
+    scopeResults.clear();
+}
+
+} // namespace pir
+} // namespace rir
@@ -0,0 +1,76 @@
+#ifndef PIR_ANALYSIS_MANAGER_H
+#define PIR_ANALYSIS_MANAGER_H
+
+#include "../pir/pir.h"
+#include "cfg.h"
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace rir {
+namespace pir {
+
+class AbstractLog;
+class ScopeAnalysis;
+
+/*
+ * Caches analysis results per Code across passes of one compilation.
+ *
+ * CFG based analyses (CFG, dominance, dominance frontier) are validated
+ * against the shape of the CFG on the first lookup in every pass run and thus
+ * stay sound even if a pass does not report its changes. Passes request their
+ * analyses up front, before they modify the code. The scope analysis depends
+ * on the instructions and their types, so it is only kept as long as no pass
+ * reports a change to the analyzed version, or to any version the analysis
+ * looked into interprocedurally (see `Pass::apply`). As a sanity check, it is
+ * also dropped when the instruction stream of the code changed.
+ */
+class AnalysisManager {
+  public:
+    AnalysisManager();
+    ~AnalysisManager();
+
+    const CFG& cfg(Code* code);
+    const DominanceGraph& dominance(Code* code);
+    const DominanceFrontier& dominanceFrontier(Code* code);
+
+    // The returned analysis has already reached its fixed-point
+    ScopeAnalysis& scope(ClosureVersion* cls, Code* code, AbstractLog& log);
+
+    // Called at the start of every pass run, see above
+    void beginPass() { ++passRun; }
+
+    // Drop everything that depends on the code of `cls` or its promises
+    void invalidate(ClosureVersion* cls);
+    void invalidateAll();
+
+  private:
+    typedef std::vector<size_t> Shape;
+
+    size_t passRun = 0;
+
+    struct CFGResults {
+        size_t validatedIn = (size_t)-1;
+        Shape shape;
+        std::unique_ptr<CFG> cfg;
+        std::unique_ptr<DominanceGraph> dom;
+        std::unique_ptr<DominanceFrontier> dfront;
+    };
+    struct ScopeResults {
+        ClosureVersion* cls;
+        size_t validatedIn = (size_t)-1;
+        Shape instructions;
+        std::unique_ptr<ScopeAnalysis> analysis;
+    };
+
+    std::unordered_map<Code*, CFGResults> cfgResults;
+    std::unordered_map<Code*, ScopeResults> scopeResults;
+
+    CFGResults& cfgResultsFor(Code* code);
+};
+
+} // namespace pir
+} // namespace rir
+
+#endif
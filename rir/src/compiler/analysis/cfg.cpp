@@ -10,7 +10,8 @@ namespace rir {
 namespace pir {
 
 CFG::CFG(Code* start)
-    : predecessors_(start->nextBBId), transitivePredecessors(start->nextBBId) {
+    : predecessors_(start->nextBBId), transitivePredecessors(start->nextBBId),
+      transitivePredecessorsDone(start->nextBBId, false) {
     Visitor::run(start->entry, [&](BB* bb) {
         if (bb->successors().size() == 0)
             exits_.push_back(bb);
@@ -19,12 +20,12 @@ CFG::CFG(Code* start)
 
 void CFG::computeTransitivePreds(BB* bb) {
     auto& preds = transitivePredecessors[bb->id];
+    preds.reserve(transitivePredecessors.size());
 
     std::stack<BB*> todo;
 
     for (auto pre : bb->predecessors()) {
-        preds.push_back(pre->id);
-        if (!pre->predecessors().empty())
+        if (preds.set(pre->id) && !pre->predecessors().empty())
             todo.push(pre);
     }
 
@@ -32,33 +33,49 @@ void CFG::computeTransitivePreds(BB* bb) {
         auto cur = todo.top();
         todo.pop();
         for (auto pre : cur->predecessors()) {
-            auto id = pre->id;
-            auto existing = std::find(preds.begin(), preds.end(), id);
-            if (existing == preds.end()) {
-                preds.push_back(id);
-                if (!pre->predecessors().empty())
-                    todo.push(pre);
-            }
+            if (preds.set(pre->id) && !pre->predecessors().empty())
+                todo.push(pre);
         }
     }
 
-    std::sort(preds.begin(), preds.end());
+    transitivePredecessorsDone[bb->id] = true;
 }
 
 bool CFG::isPredecessor(BB* a, BB* b) const {
     if (b->predecessors().size() == 0)
         return false;
-    auto& preds = transitivePredecessors[b->id];
-    if (preds.size() == 0)
+    if (!transitivePredecessorsDone[b->id])
         const_cast<CFG*>(this)->computeTransitivePreds(b);
-    auto aId = a->id;
-    for (auto i : preds) {
-        if (i == aId)
-            return true;
-        if (i > aId)
-            return false;
+    return transitivePredecessors[b->id].test(a->id);
+}
+
+constexpr unsigned ReversePostOrder::NotReached;
+
+ReversePostOrder::ReversePostOrder(Code* code)
+    : position_(code->nextBBId, NotReached) {
+    // Iterative DFS, a BB is appended once all its successors are done
+    std::vector<bool> seen(code->nextBBId, false);
+    std::stack<std::pair<BB*, size_t>> todo;
+    todo.emplace(code->entry, 0);
+    seen[code->entry->id] = true;
+    while (!todo.empty()) {
+        auto& cur = todo.top();
+        auto bb = cur.first;
+        auto succ = bb->successors();
+        if (cur.second < succ.size()) {
+            auto next = *(succ.begin() + cur.second++);
+            if (!seen[next->id]) {
+                seen[next->id] = true;
+                todo.emplace(next, 0);
+            }
+            continue;
+        }
+        order_.push_back(bb);
+        todo.pop();
     }
-    return false;
+    std::reverse(order_.begin(), order_.end());
+    for (size_t i = 0; i < order_.size(); ++i)
+        position_[order_[i]->id] = i;
 }
 
 static constexpr unsigned NoIdomId = (unsigned)-1;
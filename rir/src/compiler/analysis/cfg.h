@@ -2,6 +2,7 @@
 #define PIR_CFG_H
 
 #include "../pir/pir.h"
+#include "utils/BitVector.h"
 #include "utils/Set.h"
 
 #include <functional>
@@ -16,7 +17,9 @@ class CFG {
     typedef std::vector<BB*> BBList;
 
     std::vector<BBList> predecessors_;
-    std::vector<std::vector<size_t>> transitivePredecessors;
+    // Indexed by BB id, computed lazily
+    std::vector<BitVector> transitivePredecessors;
+    std::vector<bool> transitivePredecessorsDone;
     BBList exits_;
 
     void computeTransitivePreds(BB*);
@@ -27,6 +30,34 @@ class CFG {
     const BBList& exits() const { return exits_; }
 };
 
+/*
+ * Dense numbering of the BBs reachable from the entry in reverse post-order.
+ * Forward dataflow problems converge fastest when iterating in this order,
+ * backward problems when iterating in post-order (i.e. the reverse of it).
+ */
+class ReversePostOrder {
+  public:
+    typedef std::vector<BB*> BBList;
+
+  private:
+    BBList order_;
+    // Indexed by BB id, position in order_ or NotReached
+    std::vector<unsigned> position_;
+
+  public:
+    static constexpr unsigned NotReached = (unsigned)-1;
+
+    explicit ReversePostOrder(Code*);
+
+    const BBList& order() const { return order_; }
+    size_t size() const { return order_.size(); }
+    BB* at(size_t pos) const { return order_[pos]; }
+    unsigned position(BB* bb) const {
+        return bb->id < position_.size() ? position_[bb->id] : NotReached;
+    }
+    bool reached(BB* bb) const { return position(bb) != NotReached; }
+};
+
 class DominanceGraph {
   public:
     typedef std::vector<BB*> BBList;
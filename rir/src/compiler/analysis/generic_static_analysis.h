@@ -395,120 +395,130 @@ class StaticAnalysis {
 
         logHeader();
 
+        // Forward analyses converge fastest in reverse post-order, backward
+        // ones in post-order. BBs unreachable from the entry are never
+        // visited.
+        ReversePostOrder rpo(code);
+
         typedef std::pair<BB*, Instruction*> Position;
         std::vector<Position> recursiveTodo;
         do {
             done = true;
-            for (auto e : entrypoints) {
-                if (globalState)
-                    globalState->resetChanged();
-
-                Visitor::runInDirection(Forward, e, [&](BB* bb) {
-                    size_t id = bb->id;
-
-                    if (!changed[id])
-                        return;
-
-                    if (applyEntry(snapshots[id].entry, bb) >
-                        AbstractResult::None)
-                        changed[id] = true;
-
-                    AbstractState state = snapshots[id].entry;
-                    logInitialState(state, bb);
-
-                    auto apply = [&](Instruction* i) {
-                        AbstractResult res;
-                        if (DEBUG_LEVEL == AnalysisDebugLevel::Taint) {
-                            AbstractState old = state;
-                            res = compute(state, i);
-                            if (!Deopt::Cast(i)) {
-                                AbstractState old2 = old;
-                                auto changed = old2.merge(state);
-                                if (changed > AbstractResult::None)
-                                    logTaintChange(old, state, res, i);
-                            }
-                        } else {
-                            res = compute(state, i);
-                            logChange(state, res, i);
-                        }
-
-                        auto& snapshot = snapshots[bb->id];
-                        if (res.needRecursion) {
-                            auto& extra = snapshot.extra;
-                            const auto& entry = extra.find(i);
-                            if (entry != extra.end()) {
-                                entry->second.merge(state);
-                                state = entry->second;
-                            } else {
-                                extra.emplace(i, state);
-                            }
-                            recursiveTodo.push_back(Position(bb, i));
+            if (globalState)
+                globalState->resetChanged();
+
+            auto visit = [&](BB* bb) {
+                size_t id = bb->id;
+
+                if (!changed[id])
+                    return;
+
+                if (applyEntry(snapshots[id].entry, bb) >
+                    AbstractResult::None)
+                    changed[id] = true;
+
+                AbstractState state = snapshots[id].entry;
+                logInitialState(state, bb);
+
+                auto apply = [&](Instruction* i) {
+                    AbstractResult res;
+                    if (DEBUG_LEVEL == AnalysisDebugLevel::Taint) {
+                        AbstractState old = state;
+                        res = compute(state, i);
+                        if (!Deopt::Cast(i)) {
+                            AbstractState old2 = old;
+                            auto changed = old2.merge(state);
+                            if (changed > AbstractResult::None)
+                                logTaintChange(old, state, res, i);
                         }
+                    } else {
+                        res = compute(state, i);
+                        logChange(state, res, i);
+                    }
 
-                        if (res.keepSnapshot || snapshot.extra.count(i)) {
-                            snapshot.extra[i] = state;
+                    auto& snapshot = snapshots[bb->id];
+                    if (res.needRecursion) {
+                        auto& extra = snapshot.extra;
+                        const auto& entry = extra.find(i);
+                        if (entry != extra.end()) {
+                            entry->second.merge(state);
+                            state = entry->second;
+                        } else {
+                            extra.emplace(i, state);
                         }
-                    };
+                        recursiveTodo.push_back(Position(bb, i));
+                    }
 
-                    if (Forward)
-                        for (auto i : *bb)
-                            apply(i);
-                    else
-                        for (auto i : VisitorHelpers::reverse(*bb))
-                            apply(i);
+                    if (res.keepSnapshot || snapshot.extra.count(i)) {
+                        snapshot.extra[i] = state;
+                    }
+                };
 
-                    if (Forward ? bb->isExit() : bb == code->entry) {
-                        logExit(state);
+                if (Forward)
+                    for (auto i : *bb)
+                        apply(i);
+                else
+                    for (auto i : VisitorHelpers::reverse(*bb))
+                        apply(i);
 
-                        auto exitStateIt = exitpoints.find(bb);
-                        if (exitStateIt == exitpoints.end())
-                            exitpoints.emplace(bb, state);
-                        else
-                            exitStateIt->second = state;
+                if (Forward ? bb->isExit() : bb == code->entry) {
+                    logExit(state);
 
-                        if (reachedExit) {
-                            exitpoint.mergeExit(state);
-                        } else {
-                            exitpoint = state;
-                            reachedExit = true;
-                        }
+                    auto exitStateIt = exitpoints.find(bb);
+                    if (exitStateIt == exitpoints.end())
+                        exitpoints.emplace(bb, state);
+                    else
+                        exitStateIt->second = state;
 
-                        changed[id] = false;
-                        return;
+                    if (reachedExit) {
+                        exitpoint.mergeExit(state);
+                    } else {
+                        exitpoint = state;
+                        reachedExit = true;
                     }
 
-                    if (Forward)
-                        for (auto suc : bb->successors())
-                            mergeBranch(bb, suc, state, changed);
-                    else
-                        for (auto suc : bb->predecessors())
-                            mergeBranch(bb, suc, state, changed);
-
                     changed[id] = false;
-                });
-                if (!recursiveTodo.empty()) {
-                    for (auto& rec : recursiveTodo) {
-                        auto bb = rec.first->id;
-                        auto& extra = snapshots[bb].extra;
-                        const auto& entry = extra.find(rec.second);
-                        if (entry != extra.end()) {
-                            auto mres = entry->second.mergeExit(exitpoint);
-                            if (mres > AbstractResult::None) {
-                                logChange(entry->second, mres, rec.second);
-                                changed[bb] = true;
-                                done = false;
-                            }
-                        } else {
-                            extra.emplace(rec.second, exitpoint);
+                    return;
+                }
+
+                if (Forward)
+                    for (auto suc : bb->successors())
+                        mergeBranch(bb, suc, state, changed);
+                else
+                    for (auto suc : bb->predecessors())
+                        mergeBranch(bb, suc, state, changed);
+
+                changed[id] = false;
+            };
+            if (Forward)
+                for (auto bb : rpo.order())
+                    visit(bb);
+            else
+                for (auto bb : VisitorHelpers::reverse(rpo.order()))
+                    visit(bb);
+
+            if (!recursiveTodo.empty()) {
+                for (auto& rec : recursiveTodo) {
+                    auto bb = rec.first->id;
+                    auto& extra = snapshots[bb].extra;
+                    const auto& entry = extra.find(rec.second);
+                    if (entry != extra.end()) {
+                        auto mres = entry->second.mergeExit(exitpoint);
+                        if (mres > AbstractResult::None) {
+                            logChange(entry->second, mres, rec.second);
                             changed[bb] = true;
                             done = false;
                         }
+                    } else {
+                        extra.emplace(rec.second, exitpoint);
+                        changed[bb] = true;
+                        done = false;
                     }
-                    recursiveTodo.clear();
                 }
-                if (globalState && globalState->changed())
-                    done = false;
+                recursiveTodo.clear();
             }
+            if (globalState && globalState->changed())
+                done = false;
         } while (!done);
     }
 
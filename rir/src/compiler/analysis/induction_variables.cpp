@@ -0,0 +1,262 @@
+#include "induction_variables.h"
+#include "compiler/pir/pir_impl.h"
+
+namespace rir {
+namespace pir {
+
+static SEXP constant(Value* v) {
+    v = v->followCasts();
+    if (auto c = Const::Cast(v))
+        return c->c();
+    return v->asRValue();
+}
+
+// 1 or -1 if `v` is that integer constant, 0 otherwise
+static int unitStep(Value* v) {
+    auto c = constant(v);
+    if (!c || TYPEOF(c) != INTSXP || XLENGTH(c) != 1 ||
+        ATTRIB(c) != R_NilValue)
+        return 0;
+    auto i = INTEGER(c)[0];
+    return (i == 1 || i == -1) ? i : 0;
+}
+
+// Strips the conversions between a branch and the comparison it tests.
+// `taken` is set to the comparison result for which the branch goes to the
+// true successor.
+static Instruction* branchComparison(Value* cond, bool& taken) {
+    taken = true;
+    while (true) {
+        cond = cond->followCasts();
+        if (auto id = Identical::Cast(cond)) {
+            auto lhs = id->arg(0).val();
+            auto rhs = id->arg(1).val();
+            auto c = constant(rhs);
+            if (c != R_TrueValue && c != R_FalseValue) {
+                std::swap(lhs, rhs);
+                c = constant(rhs);
+            }
+            if (c == R_TrueValue) {
+                cond = lhs;
+            } else if (c == R_FalseValue) {
+                taken = !taken;
+                cond = lhs;
+            } else {
+                return nullptr;
+            }
+        } else if (auto n = Not::Cast(cond)) {
+            taken = !taken;
+            cond = n->arg(0).val();
+        } else if (CheckTrueFalse::Cast(cond) || AsLogical::Cast(cond)) {
+            cond = Instruction::Cast(cond)->arg(0).val();
+        } else if (Eq::Cast(cond) || Neq::Cast(cond)) {
+            return Instruction::Cast(cond);
+        } else {
+            return nullptr;
+        }
+    }
+}
+
+bool InductionVariables::InductionVariable::isInvariant(Value* v) const {
+    auto i = Instruction::Cast(v);
+    return !i || !loop->contains(i->bb());
+}
+
+InductionVariables::InductionVariables(Code* code) : loops(code) {
+    for (auto& loop : loops) {
+        auto header = loop.header();
+        InductionVariable iv;
+        iv.loop = &loop;
+        iv.preheader = loop.preheader();
+
+        // Follow the header to the branch which leaves the loop. Checkpoints
+        // and the like have only one successor in the loop.
+        BB* bb = header;
+        Instruction* cmp = nullptr;
+        bool taken = false;
+        while (!cmp && !iv.beforeTest.count(bb)) {
+            iv.beforeTest.insert(bb);
+            BB* inLoop = nullptr;
+            size_t inLoopCount = 0;
+            for (auto s : bb->successors()) {
+                if (loop.contains(s)) {
+                    inLoop = s;
+                    inLoopCount++;
+                }
+            }
+            if (inLoopCount != 1)
+                break;
+            if (bb->isBranch() && !bb->isEmpty() && Branch::Cast(bb->last())) {
+                cmp = branchComparison(bb->last()->arg(0).val(), taken);
+                // The loop must be continued if the comparison is `!=`
+                if (cmp && (Neq::Cast(cmp) != nullptr) !=
+                               (taken == (inLoop == bb->trueBranch())))
+                    cmp = nullptr;
+                if (!cmp)
+                    break;
+            } else {
+                bb = inLoop;
+            }
+        }
+        if (!cmp)
+            continue;
+
+        auto phi = Phi::Cast(cmp->arg(0).val()->followCasts());
+        iv.end = cmp->arg(1).val();
+        if (!phi || phi->bb() != header) {
+            phi = Phi::Cast(cmp->arg(1).val()->followCasts());
+            iv.end = cmp->arg(0).val();
+        }
+        if (!phi || phi->bb() != header || !iv.isInvariant(iv.end))
+            continue;
+
+        iv.phi = phi;
+        iv.init = nullptr;
+        iv.next = nullptr;
+        bool ok = true;
+        phi->eachArg([&](BB* in, Value* v) {
+            if (!loop.contains(in)) {
+                if (iv.init)
+                    ok = false;
+                iv.init = v;
+                return;
+            }
+            auto next = Add::Cast(v->followCasts());
+            if (!next || (iv.next && iv.next != next))
+                ok = false;
+            iv.next = next;
+        });
+        if (!ok || !iv.init || !iv.next || !iv.isTested(iv.next->bb()))
+            continue;
+
+        if (iv.next->arg(0).val()->followCasts() == phi)
+            iv.step = iv.next->arg(1).val();
+        else if (iv.next->arg(1).val()->followCasts() == phi)
+            iv.step = iv.next->arg(0).val();
+        else
+            continue;
+        if (!iv.isInvariant(iv.step))
+            continue;
+        iv.stepSign = unitStep(iv.step);
+        if (!iv.stepSign) {
+            auto stepPhi = Phi::Cast(iv.step->followCasts());
+            if (!stepPhi || !stepPhi->allNonEnvArgs(
+                                [](Value* v) { return unitStep(v) != 0; }))
+                continue;
+        }
+
+        if (!phi->type.isA(PirType::simpleScalarInt()) ||
+            !iv.init->type.isA(PirType::simpleScalarInt()) ||
+            !iv.end->type.isA(PirType::simpleScalarInt()))
+            continue;
+
+        // The colon loop chooses the step by comparing m' and n', thus its
+        // induction variable is well formed by construction. The (peeled)
+        // first iteration only runs if m' != n', so m' + step cannot overshoot.
+        iv.wellFormed = false;
+        if (auto rhs = ColonCastRhs::Cast(iv.end->followCasts())) {
+            auto m = rhs->newLhs()->followCasts();
+            auto init = iv.init->followCasts();
+            if (init == m) {
+                iv.wellFormed = true;
+            } else if (auto peeled = Add::Cast(init)) {
+                iv.wellFormed =
+                    peeled->arg(0).val()->followCasts() == m &&
+                    peeled->arg(1).val()->followCasts() ==
+                        iv.step->followCasts();
+            }
+        } else if (iv.stepSign) {
+            auto init = constant(iv.init);
+            auto end = constant(iv.end);
+            if (init && end && TYPEOF(init) == INTSXP &&
+                TYPEOF(end) == INTSXP && XLENGTH(init) == 1 &&
+                XLENGTH(end) == 1 && INTEGER(init)[0] != NA_INTEGER &&
+                INTEGER(end)[0] != NA_INTEGER) {
+                iv.wellFormed = iv.stepSign == 1
+                                    ? INTEGER(init)[0] <= INTEGER(end)[0]
+                                    : INTEGER(init)[0] >= INTEGER(end)[0];
+            }
+        }
+
+        ivs.emplace_back(std::move(iv));
+    }
+}
+
+const InductionVariables::InductionVariable*
+InductionVariables::at(Value* v, BB* bb) const {
+    v = v->followCasts();
+    for (const auto& iv : ivs)
+        if (iv.phi == v && iv.isTested(bb))
+            return &iv;
+    return nullptr;
+}
+
+const InductionVariables::InductionVariable*
+InductionVariables::incrementOf(Instruction* i) const {
+    for (const auto& iv : ivs)
+        if (iv.next == i)
+            return &iv;
+    return nullptr;
+}
+
+Value* InductionVariables::sameLengthInvariant(const InductionVariable& iv,
+                                               Value* vec) const {
+    if (iv.isInvariant(vec))
+        return vec;
+
+    auto vecPhi = Phi::Cast(vec->followCasts());
+    if (!vecPhi || vecPhi->bb() != iv.loop->header())
+        return nullptr;
+
+    Value* init = nullptr;
+    std::unordered_set<Value*> seen = {vecPhi};
+    std::vector<Value*> todo;
+    vecPhi->eachArg([&](BB* in, Value* v) {
+        if (iv.loop->contains(in))
+            todo.push_back(v);
+        else
+            init = v;
+    });
+    if (!init || !iv.isInvariant(init))
+        return nullptr;
+
+    // Every value flowing back into the header must be the vector itself,
+    // updated at index iv with a scalar. Assigning in bounds of a non-object
+    // does not change its length.
+    while (!todo.empty()) {
+        auto v = todo.back()->followCasts();
+        todo.pop_back();
+        if (!seen.insert(v).second)
+            continue;
+        auto i = Instruction::Cast(v);
+        if (!i || !iv.loop->contains(i->bb()))
+            return nullptr;
+        if (auto phi = Phi::Cast(i)) {
+            phi->eachArg([&](BB*, Value* in) { todo.push_back(in); });
+            continue;
+        }
+        Value* updated = nullptr;
+        Value* idx = nullptr;
+        Value* val = nullptr;
+        if (auto sa = Subassign1_1D::Cast(i)) {
+            updated = sa->vec();
+            idx = sa->idx();
+            val = sa->val();
+        } else if (auto sa = Subassign2_1D::Cast(i)) {
+            updated = sa->vec();
+            idx = sa->idx();
+            val = sa->val();
+        } else {
+            return nullptr;
+        }
+        if (idx->followCasts() != iv.phi || !iv.isTested(i->bb()) ||
+            updated->type.maybeObj() ||
+            !val->type.isA(PirType::num().scalar().notObject()))
+            return nullptr;
+        todo.push_back(updated);
+    }
+    return init;
+}
+
+} // namespace pir
+} // namespace rir
@@ -0,0 +1,86 @@
+#ifndef PIR_INDUCTION_VARIABLES_H
+#define PIR_INDUCTION_VARIABLES_H
+
+#include "compiler/analysis/loop_detection.h"
+#include "compiler/pir/pir.h"
+
+#include <unordered_set>
+#include <vector>
+
+namespace rir {
+namespace pir {
+
+/*
+ * Finds the basic induction variables of the loops in a code object. These are
+ * integer phis in a loop header of the shape
+ *
+ *   BB<header>:
+ *     iv   = Phi(init:<preheader>, next:<latch>...)
+ *     ...
+ *     Branch(iv != end)          (the other successor leaves the loop)
+ *   BB<in the loop>:
+ *     next = Add(iv, step)
+ *
+ * where init, end and step are loop invariant and step is 1L, -1L, or a Phi
+ * of those. This is what compileSimpleFor emits for `for (i in m:n)`, with
+ * init = m' (or m' + step when the first iteration was peeled) and end = n'.
+ *
+ * If the loop is entered with init on the correct side of end (init <= end
+ * for a step of 1, init >= end for -1), then past the exit test the iv lies in
+ * [min(init, end + 1), max(init, end - 1)]. This is either known statically
+ * (`wellFormed`), or has to be tested at runtime before entering the loop.
+ */
+class InductionVariables {
+  public:
+    struct InductionVariable {
+        Phi* phi;
+        Add* next;
+        Value* init;
+        Value* end;
+        Value* step;
+        // 1 or -1 if the step is a constant, 0 if it is a Phi of both
+        int stepSign;
+        // The single out-of-loop predecessor of the header, if any
+        BB* preheader;
+        // True if init is on the correct side of end by construction
+        bool wellFormed;
+
+        const LoopDetection::Loop* loop;
+        // Header and the blocks leading up to the exit test. Everywhere else
+        // in the loop the exit test has passed.
+        std::unordered_set<BB*> beforeTest;
+
+        bool isTested(BB* bb) const {
+            return loop->contains(bb) && !beforeTest.count(bb);
+        }
+        bool isInvariant(Value* v) const;
+    };
+
+    explicit InductionVariables(Code* code);
+
+    InductionVariables(const InductionVariables&) = delete;
+    InductionVariables& operator=(const InductionVariables&) = delete;
+
+    // The induction variable `v` refers to, if its value in `bb` is known to be
+    // in range (see above).
+    const InductionVariable* at(Value* v, BB* bb) const;
+    // The induction variable `i` is the increment of.
+    const InductionVariable* incrementOf(Instruction* i) const;
+
+    // A loop invariant vector which has the same length as `vec` everywhere
+    // the exit test of `iv` has passed, provided `iv` is in bounds of it. This
+    // is `vec` itself if it is invariant, or the initial value of a vector
+    // which is only updated in place at index `iv`, as in `x[i] <- x[i] + 1`.
+    Value* sameLengthInvariant(const InductionVariable& iv, Value* vec) const;
+
+    bool empty() const { return ivs.empty(); }
+
+  private:
+    LoopDetection loops;
+    std::vector<InductionVariable> ivs;
+};
+
+} // namespace pir
+} // namespace rir
+
+#endif
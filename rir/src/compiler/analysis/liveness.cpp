@@ -3,46 +3,68 @@
 #include "../pir/instruction.h"
 #include "../util/visitor.h"
 #include "compiler/analysis/cfg.h"
-
-#include <map>
-#include <set>
+#include "utils/BitVector.h"
 
 namespace rir {
 namespace pir {
 
 LivenessIntervals::LivenessIntervals(Code* code, unsigned bbsSize) {
-    // temp list of live out sets for every BB
-    // ordered set so we can use std::includes
-    std::unordered_map<BB*, std::set<Value*>> liveAtEnd(bbsSize);
+    // Values are numbered densely in the order we first see them, such that
+    // live sets can be represented as bitvectors
+    std::unordered_map<Value*, unsigned> valueIds;
+    std::vector<Value*> values;
+    auto idOf = [&](Value* v) {
+        auto it = valueIds.find(v);
+        if (it != valueIds.end())
+            return it->second;
+        unsigned id = values.size();
+        valueIds.emplace(v, id);
+        values.push_back(v);
+        return id;
+    };
+
+    // temp list of live out sets for every BB, indexed by BB id
+    std::vector<BitVector> liveAtEnd(bbsSize);
+    // BBs which have been reached by the analysis so far
+    std::vector<bool> reached(bbsSize, false);
 
-    DominanceGraph dom(code);
-    // this is a backwards analysis, starting from CFG exits
-    std::unordered_set<BB*> todo;
-    Visitor::run(code->entry, [&](BB* bb) {
+    // this is a backwards analysis, starting from CFG exits. The worklist is
+    // indexed by post-order position, such that we always pick the BB
+    // closest to the exits first.
+    ReversePostOrder rpo(code);
+    BitVector todo(rpo.size());
+    auto schedule = [&](BB* bb) {
+        if (rpo.reached(bb))
+            todo.set(rpo.size() - 1 - rpo.position(bb));
+    };
+    for (auto bb : rpo.order())
         if (bb->isExit())
-            todo.insert(bb);
-    });
+            schedule(bb);
 
 restart:
     while (!todo.empty()) {
-        BB* bb = *todo.begin();
-        todo.erase(todo.begin());
+        auto next = todo.findFirst();
+        todo.reset(next);
+        BB* bb = rpo.at(rpo.size() - 1 - next);
+        reached[bb->id] = true;
 
         // keep track of currently live variables
-        // ordered sets so we can use std::includes
-        std::set<Value*> accumulated;
-        std::unordered_map<BB*, std::set<Value*>> accumulatedPhiInput;
+        BitVector accumulated(values.size());
+        size_t accumulatedSize = 0;
+        std::unordered_map<BB*, BitVector> accumulatedPhiInput;
 
         // Mark all (backwards) incoming live variables
-        for (const auto& v : liveAtEnd[bb]) {
+        liveAtEnd[bb->id].forEach([&](size_t id) {
+            auto v = values[id];
             assert(count(v));
             auto& liveRange = intervals[v][bb->id];
             if (!liveRange.live || liveRange.end < bb->size()) {
                 liveRange.live = true;
                 liveRange.end = bb->size();
-                accumulated.insert(v);
+                if (accumulated.set(id))
+                    accumulatedSize++;
             }
-        }
+        });
 
         // Run BB in reverse
         size_t pos = bb->size();
@@ -73,7 +95,7 @@ restart:
                 if (auto phi = Phi::Cast(i)) {
                     phi->eachArg([&](BB* in, Value* v) {
                         if (markIfNotSeen(v))
-                            accumulatedPhiInput[in].insert(v);
+                            accumulatedPhiInput[in].set(idOf(v));
                     });
                 } else {
                     std::function<void(Value*)> apply = [&](Value* v) {
@@ -85,24 +107,26 @@ restart:
                             // individually until used.
                             if (v->type.isCompositeValue())
                                 apply(v);
-                            else if (markIfNotSeen(v))
-                                accumulated.insert(v);
+                            else if (markIfNotSeen(v) &&
+                                     accumulated.set(idOf(v)))
+                                accumulatedSize++;
                         });
                     };
                     apply(i);
                 }
 
                 // Mark the end of the current instructions liveness
-                if (accumulated.count(i)) {
+                auto id = valueIds.find(i);
+                if (id != valueIds.end() && accumulated.reset(id->second)) {
                     assert(count(i));
                     auto& liveRange = intervals[i][bb->id];
                     assert(liveRange.live);
                     liveRange.begin = pos;
-                    accumulated.erase(accumulated.find(i));
+                    accumulatedSize--;
                 }
 
-                if (accumulated.size() > maxLive)
-                    maxLive = accumulated.size();
+                if (accumulatedSize > maxLive)
+                    maxLive = accumulatedSize;
 
             } while (ip != bb->begin());
         }
@@ -111,46 +135,38 @@ restart:
         // Mark everything that is live at the beginning of the BB.
         // Note that we need a separate `liveAtEntry` flag; begin = 0 cannot
         // distinguish between liveness before or after the first instruction.
-        auto markLiveEntry = [&](Value* v) {
+        auto markLiveEntry = [&](size_t id) {
+            auto v = values[id];
             assert(count(v));
             auto& liveRange = intervals[v][bb->id];
             assert(liveRange.live);
             liveRange.liveAtEntry = true;
             liveRange.begin = 0;
         };
-        for (const auto& v : accumulated)
-            markLiveEntry(v);
+        accumulated.forEach(markLiveEntry);
         for (const auto& pi : accumulatedPhiInput)
-            for (const auto& v : pi.second)
-                markLiveEntry(v);
+            pi.second.forEach(markLiveEntry);
 
         // Merge everything that is live at the beginning of the BB into the
         // incoming vars of all predecessors
         //
         // Phi inputs should only be merged to BB that are successors of the
         // input BBs
-        auto merge = [&](BB* bb, const std::set<Value*>& live) {
-            auto& liveOut = liveAtEnd[bb];
-            if (!std::includes(liveOut.begin(), liveOut.end(), live.begin(),
-                               live.end())) {
-                liveOut.insert(live.begin(), live.end());
-                todo.insert(bb);
-            }
+        auto merge = [&](BB* bb, const BitVector& live) {
+            if (liveAtEnd[bb->id].unionWith(live))
+                schedule(bb);
         };
         auto mergePhiInp = [&](BB* bb) {
-            for (const auto& in : accumulatedPhiInput) {
-                auto& inBB = in.first;
-                auto& inLive = in.second;
-                if (bb == inBB) {
-                    merge(bb, inLive);
-                }
-            }
+            auto in = accumulatedPhiInput.find(bb);
+            if (in != accumulatedPhiInput.end())
+                merge(bb, in->second);
         };
         for (const auto& pre : bb->predecessors()) {
-            if (!liveAtEnd.count(pre)) {
-                liveAtEnd[pre] = accumulated;
+            if (!reached[pre->id]) {
+                reached[pre->id] = true;
+                liveAtEnd[pre->id] = accumulated;
                 mergePhiInp(pre);
-                todo.insert(pre);
+                schedule(pre);
             } else {
                 merge(pre, accumulated);
                 mergePhiInp(pre);
@@ -160,11 +176,12 @@ restart:
 
     // enqueue nodes that are alive and have a non-live successor
     // to be processed on the next iteration
-    for (auto p : liveAtEnd) {
-        auto bb = p.first;
+    for (auto bb : rpo.order()) {
+        if (!reached[bb->id])
+            continue;
         for (auto n : bb->successors()) {
-            if (!liveAtEnd.count(n))
-                todo.insert(n);
+            if (!reached[n->id])
+                schedule(n);
         }
     }
 
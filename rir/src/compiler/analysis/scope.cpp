@@ -611,5 +611,12 @@ void ScopeAnalysis::tryMaterializeEnv(const ScopeAnalysisState& state,
     action(theEnv);
 }
 
+void ScopeAnalysis::eachDependency(
+    const std::function<void(ClosureVersion*)>& it) const {
+    it(closure);
+    for (const auto& sub : subAnalysis)
+        sub.second->eachDependency(it);
+}
+
 } // namespace pir
 } // namespace rir
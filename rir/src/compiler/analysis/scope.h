@@ -243,6 +243,10 @@ class ScopeAnalysis
         MaybeMaterialized;
     void tryMaterializeEnv(const ScopeAnalysisState& state, Value* env,
                            const MaybeMaterialized&);
+
+    // All closure versions whose code contributed to this analysis, including
+    // the ones analyzed interprocedurally.
+    void eachDependency(const std::function<void(ClosureVersion*)>&) const;
 };
 
 } // namespace pir
@@ -16,6 +16,7 @@
 #include "compiler/util/visitor.h"
 #include "interpreter/instance.h"
 #include "runtime/DispatchTable.h"
+#include "runtime/SpeculatedBindings.h"
 #include "simple_instruction_list.h"
 #include "utils/FunctionWriter.h"
 #include "utils/measuring.h"
@@ -380,7 +381,8 @@ rir::Function* Backend::doCompile(ClosureVersion* cls, ClosureLog& log) {
         std::unordered_set<Instruction*> needsLdVarForUpdate;
         approximateNeedsLdVarForUpdate(c, needsLdVarForUpdate);
         auto res = done[c] = rir::Code::NewNative(c->rirSrc()->src);
-        // Can we do better?
+        // Only until the Function is installed, the Backend releases it when
+        // done. Afterwards the native code lives as long as the Code object.
         preserve(res->container());
         auto& pm = promMap.at(c);
         // Order of prms in the extra pool must equal id in promMap
@@ -409,6 +411,7 @@ rir::Function* Backend::doCompile(ClosureVersion* cls, ClosureLog& log) {
         c.second->function(function.function());
 
     function.function()->inheritFlags(cls->owner()->rirFunction());
+    SpeculatedBindings::record(function.function(), cls->speculatedBindings);
     return function.function();
 }
 
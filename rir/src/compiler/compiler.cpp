@@ -141,6 +141,17 @@ void Compiler::compileClosure(Closure* closure, rir::Function* optFunction,
     auto version = closure->declareVersion(ctx, root, optFunction);
     Builder builder(version, closure->closureEnv());
     auto& log = logger.open(version);
+
+    // Args with constant value feedback are known to have that value
+    if (ctx.getTypeFlags().includes(TypeAssumption::ConstantArgs_)) {
+        auto bb = builder.getCurrentBB();
+        for (auto it = bb->begin(); it != bb->end(); ++it) {
+            if (auto ld = LdArg::Cast(*it)) {
+                if (auto c = closure->rirFunction()->constantArg(ld->pos))
+                    ld->replaceUsesWith(module->c(c));
+            }
+        }
+    }
     Rir2Pir rir2pir(*this, version, log, closure->name(), outerFeedback);
 
     auto& context = version->context();
@@ -212,6 +223,7 @@ void Compiler::compileClosure(Closure* closure, rir::Function* optFunction,
     if (failedToCompileDefaultArgs) {
         logger.warn("Failed to compile default arg");
         logger.close(version);
+        analyses.invalidate(version);
         closure->erase(ctx);
         delete version;
         return fail();
@@ -232,6 +244,7 @@ void Compiler::compileClosure(Closure* closure, rir::Function* optFunction,
     log.failed("rir2pir aborted");
     log.flush();
     logger.close(version);
+    analyses.invalidate(version);
     closure->erase(ctx);
     delete version;
     return fail();
@@ -239,7 +252,8 @@ void Compiler::compileClosure(Closure* closure, rir::Function* optFunction,
 
 bool MEASURE_COMPILER_PERF = getenv("PIR_MEASURE_COMPILER") ? true : false;
 
-static void findUnreachable(Module* m, Log& log, const std::string& where) {
+static void findUnreachable(Module* m, Log& log, AnalysisManager& analyses,
+                            const std::string& where) {
     std::unordered_map<Closure*, std::unordered_set<Context>> reachable;
     bool changed = true;
 
@@ -312,6 +326,7 @@ static void findUnreachable(Module* m, Log& log, const std::string& where) {
         c->eachVersion([&](ClosureVersion* v) {
             if (!reachableVersions.count(v->context())) {
                 toErase.push_back({v->owner(), v->context()});
+                analyses.invalidate(v);
                 log.close(v);
                 delete v;
             }
@@ -362,7 +377,8 @@ void Compiler::optimizeModule() {
         if (translation->isSlow()) {
             if (MEASURE_COMPILER_PERF)
                 Measuring::startTimer("compiler.cpp: module cleanup");
-            findUnreachable(module, logger, translation->getName());
+            findUnreachable(module, logger, analyses,
+                            translation->getName());
             if (MEASURE_COMPILER_PERF)
                 Measuring::countTimer("compiler.cpp: module cleanup");
         }
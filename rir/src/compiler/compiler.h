@@ -2,6 +2,7 @@
 #define RIR_2_PIR_COMPILER_H
 
 #include "R/Preserve.h"
+#include "compiler/analysis/analysis_manager.h"
 #include "compiler/log/log.h"
 #include "pir/pir.h"
 #include "utils/FormalArgs.h"
@@ -52,6 +53,9 @@ class Compiler {
 
     Module* module;
 
+    // Analyses shared between passes, see Pass::apply for invalidation
+    AnalysisManager analyses;
+
   private:
     Log& logger;
 
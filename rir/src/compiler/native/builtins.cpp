@@ -10,6 +10,7 @@
 #include "runtime/LazyArglist.h"
 #include "runtime/LazyEnvironment.h"
 #include "runtime/TypeFeedback.h"
+#include "utils/JitStats.h"
 #include "utils/Pool.h"
 
 #include "R/Protect.h"
@@ -145,6 +146,14 @@ SEXP ldvarImpl(SEXP n, SEXP env) {
 
 SEXP ldvarGlobalImpl(SEXP a) { return Rf_findVar(a, R_GlobalEnv); }
 
+SEXP ldvarSuperImpl(SEXP n, SEXP env, rir::Code* c) {
+    if (LazyEnvironment::check(env))
+        return ldvarImpl(n, env);
+    auto res = cachedGetSuperVar(c, n, env);
+    ENSURE_NAMED(res);
+    return res;
+}
+
 SEXP ldvarCachedImpl(SEXP sym, SEXP env, SEXP* cache) {
     if (*cache != (SEXP)NativeBuiltins::bindingsCacheFails) {
         R_varloc_t loc = R_findVarLocInFrame(env, sym);
@@ -163,7 +172,7 @@ SEXP ldvarCachedImpl(SEXP sym, SEXP env, SEXP* cache) {
     return res;
 }
 
-void stvarSuperImpl(SEXP a, SEXP val, SEXP env) {
+void stvarSuperImpl(SEXP a, SEXP val, SEXP env, rir::Code* c) {
     auto le = LazyEnvironment::check(env);
     assert(!le || !le->materialized());
     SEXP superEnv;
@@ -171,11 +180,16 @@ void stvarSuperImpl(SEXP a, SEXP val, SEXP env) {
         superEnv = le->getParent();
     else
         superEnv = ENCLOS(env);
-    rirSetVarWrapper(a, val, superEnv);
+    rirSetVarWrapper(a, val, superEnv, c);
 }
 
 void stvarImpl(SEXP a, SEXP val, SEXP c) { rirDefineVarWrapper(a, val, c); }
 
+void stvarCachedImpl(SEXP sym, SEXP val, SEXP env, SEXP* cache) {
+    if (auto cell = rirDefineVarWrapper(sym, val, env))
+        *cache = cell;
+}
+
 void stvarImplI(SEXP a, int val, SEXP c) { rirDefineVarWrapper(a, val, c); }
 
 void stvarImplR(SEXP a, double val, SEXP c) { rirDefineVarWrapper(a, val, c); }
@@ -231,9 +245,9 @@ void externalsxpSetEntryImpl(SEXP x, int i, SEXP y) {
     EXTERNALSXP_SET_ENTRY(x, i, y);
 }
 
-void defvarImpl(SEXP var, SEXP value, SEXP env) {
+void defvarImpl(SEXP var, SEXP value, SEXP env, rir::Code* c) {
     assert(TYPEOF(env) == ENVSXP);
-    rirSetVarWrapper(var, value, ENCLOS(env));
+    rirSetVarWrapper(var, value, ENCLOS(env), c);
 }
 
 SEXP chkfunImpl(SEXP sym, SEXP res) {
@@ -831,6 +845,7 @@ static SEXP deoptSentinelContainer = []() {
 void deoptImpl(rir::Code* c, SEXP cls, DeoptMetadata* m, R_bcstack_t* args,
                bool leakedEnv, DeoptReason* deoptReason, SEXP deoptTrigger) {
     deoptReason->record(deoptTrigger);
+    JitStats::deopts[deoptReason->reason]++;
 
     assert(m->numFrames >= 1);
     size_t stackHeight = 0;
@@ -889,6 +904,7 @@ void deoptImpl(rir::Code* c, SEXP cls, DeoptMetadata* m, R_bcstack_t* args,
             // We have an optimized continuation, let's call it and then
             // non-local return its result.
             if (fun) {
+                JitStats::deoptlessHits++;
                 // Adapting calling convention: deoptless wants the env as
                 // individual arguments on the stack.
                 // TODO: speed this up by already passing it that way...
@@ -927,7 +943,9 @@ void deoptImpl(rir::Code* c, SEXP cls, DeoptMetadata* m, R_bcstack_t* args,
                 auto code = fun->body();
                 auto nc = code->nativeCode();
                 deoptlessRecursion = cls;
+                PROTECT(code->container());
                 auto res = nc(code, base, env, closure);
+                UNPROTECT(1);
                 deoptlessRecursion = nullptr;
 
                 Rf_findcontext(CTXT_BROWSER | CTXT_FUNCTION,
@@ -1304,6 +1322,86 @@ static void endClosureContext(RCNTXT* cntxt, SEXP result) {
     Rf_endcontext(cntxt);
 }
 
+// Boxes all arguments the native code of `fun` does not read unboxed, see
+// LowerFunctionLLVM::withCallFrame.
+static void boxUnexpectedArgs(R_bcstack_t* args, size_t nargs, Function* fun) {
+    auto context = fun->context();
+    for (size_t i = 0; i < nargs; ++i) {
+        auto tag = args[i].tag;
+        auto expected = (tag == INTSXP && context.isSimpleInt(i)) ||
+                        (tag == REALSXP && context.isSimpleReal(i));
+        if (tag != 0 && !expected)
+            ostack_box_cell(args + i);
+    }
+}
+
+// Calls the native code of fun in a new closure context. The nargs arguments
+// of the call are on top of the node stack.
+static SEXP callNativeCode(CallContext& call, Function* fun) {
+    R_CheckStack();
+#ifdef ENABLE_SLOWASSERT
+    auto t = R_BCNodeStackTop;
+#endif
+
+    auto nargs = call.suppliedArgs;
+    auto env = call.callerEnv;
+    auto callee = call.callee;
+
+    auto missing = fun->nargs() - nargs;
+    for (size_t i = 0; i < missing; ++i)
+        ostack_push(R_MissingArg);
+
+    R_bcstack_t* args = ostack_cell_at((long)(nargs + missing) - 1);
+
+    LazyArglistOnStack lazyArgs(call.callId,
+                                call.caller->arglistOrderContainer(),
+                                call.suppliedArgs, call.stackArgs, call.ast);
+
+    assert(fun->signature().envCreation ==
+           FunctionSignature::Environment::CalleeCreated);
+
+    RCNTXT cntxt;
+
+    // This code needs to be protected, because its slot in the dispatch table
+    // could get overwritten while we are executing it.
+    PROTECT(fun->container());
+
+    initClosureContext(call.ast, &cntxt, symbol::delayedEnv, env,
+                       lazyArgs.asSexp(), callee);
+    R_Srcref = Rf_getAttrib(callee, symbol::srcref);
+
+    // TODO debug
+
+    SEXP result;
+    auto code = fun->body();
+    if ((SETJMP(cntxt.cjmpbuf))) {
+        if (R_ReturnedValue == R_RestartToken) {
+            cntxt.callflag = CTXT_RETURN; /* turn restart off */
+            R_ReturnedValue = R_NilValue; /* remove restart token */
+            fun->registerInvocation();
+            result = code->nativeCode()(code, args, env, callee);
+            fun->registerEndInvocation();
+        } else {
+            result = R_ReturnedValue;
+        }
+    } else {
+        result = code->nativeCode()(code, args, env, callee);
+    }
+
+    endClosureContext(&cntxt, result);
+
+    PROTECT(result);
+    R_Srcref = cntxt.srcref;
+    R_ReturnedValue = R_NilValue;
+
+    UNPROTECT(2);
+    ostack_popn(missing);
+
+    SLOWASSERT(t == R_BCNodeStackTop);
+    fun->registerEndInvocation();
+    return result;
+}
+
 static SEXP nativeCallTrampolineImpl(ArglistOrder::CallId callId, rir::Code* c,
                                      SEXP callee, Immediate target,
                                      Immediate astP, SEXP env, size_t nargs,
@@ -1313,14 +1411,16 @@ static SEXP nativeCallTrampolineImpl(ArglistOrder::CallId callId, rir::Code* c,
                env == R_NilValue || LazyEnvironment::check(env));
 
     auto fun = Function::unpack(Pool::get(target));
+    auto stackArgs = ostack_cell_at((long)nargs - 1);
 
-    CallContext call(callId, c, callee, nargs, astP,
-                     ostack_cell_at((long)nargs - 1), env, R_NilValue,
-                     Context(available));
+    CallContext call(callId, c, callee, nargs, astP, stackArgs, env,
+                     R_NilValue, Context(available));
 
     auto missingAsmpt = (Context*)(DATAPTR(cp_pool_at(missingAsmpt_)));
     auto fail = !missingAsmpt->empty();
     if (fail) {
+        for (size_t i = 0; i < nargs; ++i)
+            ostack_box_cell(stackArgs + i);
         if (missingAsmpt->numMissing() == 0 &&
             missingAsmpt->getFlags().empty()) {
             fail = false;
@@ -1348,12 +1448,26 @@ static SEXP nativeCallTrampolineImpl(ArglistOrder::CallId callId, rir::Code* c,
                 if (missingAsmpt->getTypeFlags().includes(flag))
                     switch (flag) {
 #define FOR_ALL_ARGS(v)                                                        \
+    v(0);                                                                      \
+    v(1);                                                                      \
+    v(2);                                                                      \
+    v(3);                                                                      \
+    v(4);                                                                      \
+    v(5);                                                                      \
+    v(6);                                                                      \
+    v(7);                                                                      \
+    v(8);
+#define FOR_SCALAR_TYPED_ARGS(v)                                               \
     v(0);                                                                      \
     v(1);                                                                      \
     v(2);                                                                      \
     v(3);                                                                      \
     v(4);                                                                      \
     v(5);
+#define FOR_VECTOR_TYPED_ARGS(v)                                               \
+    v(0);                                                                      \
+    v(1);                                                                      \
+    v(2);
 
 #define CHECK_EAGER(__i__)                                                     \
     case TypeAssumption::Arg##__i__##IsNonRefl_:                               \
@@ -1383,7 +1497,7 @@ static SEXP nativeCallTrampolineImpl(ArglistOrder::CallId callId, rir::Code* c,
             fail = true;                                                       \
         break;                                                                 \
     }
-                        FOR_ALL_ARGS(CHECK_INT)
+                        FOR_SCALAR_TYPED_ARGS(CHECK_INT)
 #undef CHECK_INT
 #define CHECK_REAL(__i__)                                                      \
     case TypeAssumption::Arg##__i__##IsSimpleReal_: {                          \
@@ -1393,9 +1507,53 @@ static SEXP nativeCallTrampolineImpl(ArglistOrder::CallId callId, rir::Code* c,
             fail = true;                                                       \
         break;                                                                 \
     }
-                        FOR_ALL_ARGS(CHECK_REAL)
+                        FOR_SCALAR_TYPED_ARGS(CHECK_REAL)
 #undef CHECK_REAL
+#define CHECK_PLAIN_NUM_VEC(__i__)                                             \
+    case TypeAssumption::Arg##__i__##IsPlainNumVec_:                           \
+    case TypeAssumption::Arg##__i__##IsNAFree_:                                \
+    case TypeAssumption::Arg##__i__##IsPlainList_: {                           \
+        auto a = loadArg(__i__);                                               \
+        Context shape;                                                         \
+        if (a != R_UnboundValue && a != R_MissingArg)                          \
+            shape.setValueShape(__i__, a);                                     \
+        if (!shape.getTypeFlags().includes(flag))                              \
+            fail = true;                                                       \
+        break;                                                                 \
+    }
+                        FOR_VECTOR_TYPED_ARGS(CHECK_PLAIN_NUM_VEC)
+#undef CHECK_PLAIN_NUM_VEC
+#undef FOR_VECTOR_TYPED_ARGS
+#undef FOR_SCALAR_TYPED_ARGS
 #undef FOR_ALL_ARGS
+                    case TypeAssumption::RestAreNonRefl_:
+                    case TypeAssumption::RestAreEager_:
+                        for (size_t i = Context::NUM_TYPED_ARGS; i < nargs;
+                             ++i) {
+                            auto a = call.stackArg(i);
+                            if (TYPEOF(a) == PROMSXP &&
+                                PRVALUE(a) == R_UnboundValue)
+                                fail = true;
+                        }
+                        break;
+                    case TypeAssumption::ConstantArgs_:
+                        if (!call.givenContext.includes(
+                                Assumption::CorrectOrderOfArguments) ||
+                            !matchConstantArgs(call, false))
+                            fail = true;
+                        break;
+                    case TypeAssumption::RestAreNotObj_:
+                        for (size_t i = Context::NUM_TYPED_ARGS; i < nargs;
+                             ++i) {
+                            auto a = call.stackArg(i);
+                            if (TYPEOF(a) == PROMSXP)
+                                a = PRVALUE(a);
+                            if (a == R_UnboundValue || a == R_MissingArg ||
+                                Rf_isObject(a) || TYPEOF(a) == CLOSXP ||
+                                TYPEOF(a) == ENVSXP)
+                                fail = true;
+                        }
+                        break;
                     }
                 flag = (TypeAssumption)((unsigned)flag + 1);
             }
@@ -1418,6 +1576,8 @@ static SEXP nativeCallTrampolineImpl(ArglistOrder::CallId callId, rir::Code* c,
     static int recheck = 0;
     if (fail || (++recheck == 97 && RecompileHeuristic(fun))) {
         recheck = 0;
+        for (size_t i = 0; i < nargs; ++i)
+            ostack_box_cell(stackArgs + i);
         inferCurrentContext(call, fun->nargs());
         if (fail || RecompileCondition(dt, fun, call.givenContext)) {
             fun->unregisterInvocation();
@@ -1429,65 +1589,30 @@ static SEXP nativeCallTrampolineImpl(ArglistOrder::CallId callId, rir::Code* c,
         }
     }
 
-    R_CheckStack();
-#ifdef ENABLE_SLOWASSERT
-    auto t = R_BCNodeStackTop;
-#endif
-
-    auto missing = fun->nargs() - nargs;
-    for (size_t i = 0; i < missing; ++i)
-        ostack_push(R_MissingArg);
-
-    R_bcstack_t* args = ostack_cell_at((long)(nargs + missing) - 1);
-    auto ast = cp_pool_at(astP);
-
-    LazyArglistOnStack lazyArgs(call.callId,
-                                call.caller->arglistOrderContainer(),
-                                call.suppliedArgs, call.stackArgs, call.ast);
-
-    assert(fun->signature().envCreation ==
-           FunctionSignature::Environment::CalleeCreated);
-
-    RCNTXT cntxt;
-
-    // This code needs to be protected, because its slot in the dispatch table
-    // could get overwritten while we are executing it.
-    PROTECT(fun->container());
+    boxUnexpectedArgs(stackArgs, nargs, fun);
+    return callNativeCode(call, fun);
+}
 
-    initClosureContext(ast, &cntxt, symbol::delayedEnv, env, lazyArgs.asSexp(),
-                       callee);
-    R_Srcref = Rf_getAttrib(callee, symbol::srcref);
+// A version calling itself. Its arguments satisfy the version's own context, so
+// there is nothing to dispatch or check.
+static SEXP nativeSelfCallImpl(ArglistOrder::CallId callId, rir::Code* c,
+                               SEXP callee, Immediate astP, SEXP env,
+                               size_t nargs, unsigned long available) {
+    auto fun = c->function();
+    auto stackArgs = ostack_cell_at((long)nargs - 1);
 
-    // TODO debug
+    CallContext call(callId, c, callee, nargs, astP, stackArgs, env,
+                     R_NilValue, Context(available));
 
-    SEXP result;
-    auto code = fun->body();
-    if ((SETJMP(cntxt.cjmpbuf))) {
-        if (R_ReturnedValue == R_RestartToken) {
-            cntxt.callflag = CTXT_RETURN; /* turn restart off */
-            R_ReturnedValue = R_NilValue; /* remove restart token */
-            fun->registerInvocation();
-            result = code->nativeCode()(code, args, env, callee);
-            fun->registerEndInvocation();
-        } else {
-            result = R_ReturnedValue;
-        }
-    } else {
-        result = code->nativeCode()(code, args, env, callee);
+    // Disabled versions are not entered anymore
+    if (fun->disabled()) {
+        for (size_t i = 0; i < nargs; ++i)
+            ostack_box_cell(stackArgs + i);
+        return doCall(call, true);
     }
 
-    endClosureContext(&cntxt, result);
-
-    PROTECT(result);
-    R_Srcref = cntxt.srcref;
-    R_ReturnedValue = R_NilValue;
-
-    UNPROTECT(2);
-    ostack_popn(missing);
-
-    SLOWASSERT(t == R_BCNodeStackTop);
-    fun->registerEndInvocation();
-    return result;
+    fun->registerInvocation();
+    return callNativeCode(call, fun);
 }
 
 SEXP subassign11Impl(SEXP vector, SEXP index, SEXP value, SEXP env,
@@ -2145,13 +2270,17 @@ SEXP toForSeqImpl(SEXP seq) {
     return seq;
 }
 
+// The arguments are kept in slots of the native frame until the context is
+// popped. The arglist lives in the native frame too, no heap object is needed.
 void initClosureContextImpl(ArglistOrder::CallId callId, rir::Code* c, SEXP ast,
                             RCNTXT* cntxt, SEXP sysparent, SEXP op,
-                            size_t nargs) {
+                            size_t nargs, R_bcstack_t* args,
+                            LazyArglistOnStack* arglist) {
     auto lazyArglist =
-        LazyArglistOnHeap::New(callId, c->arglistOrderContainer(), nargs,
-                               ostack_cell_at((long)nargs - 1), ast);
-    ostack_popn(nargs);
+        (new (arglist) LazyArglistOnStack(
+             LazyArglistOnStack::InNativeFrame(), callId,
+             c->arglistOrderContainer(), nargs, args, ast))
+            ->asSexp();
 
     auto global = (RCNTXT*)R_GlobalContext;
     if (global->callflag == CTXT_GENERIC)
@@ -2297,12 +2426,24 @@ void NativeBuiltins::initializeBuiltins() {
     get_(Id::ldvar) = {"ldvar", (void*)&ldvarImpl, t::sexp_sexpsexp};
     get_(Id::ldvarGlobal) = {"ldvarGlobal", (void*)&ldvarGlobalImpl,
                              t::sexp_sexp};
+    get_(Id::ldvarSuper) = {
+        "ldvarSuper", (void*)&ldvarSuperImpl,
+        llvm::FunctionType::get(t::SEXP, {t::SEXP, t::SEXP, t::voidPtr},
+                                false)};
     get_(Id::ldvarCacheMiss) = {
         "ldvarCacheMiss", (void*)&ldvarCachedImpl,
         llvm::FunctionType::get(t::SEXP, {t::SEXP, t::SEXP, t::SEXP_ptr},
                                 false)};
-    get_(Id::stvarSuper) = {"stvarSuper", (void*)&stvarSuperImpl,
-                            t::void_sexpsexpsexp};
+    get_(Id::stvarCacheMiss) = {
+        "stvarCacheMiss", (void*)&stvarCachedImpl,
+        llvm::FunctionType::get(t::Void,
+                                {t::SEXP, t::SEXP, t::SEXP, t::SEXP_ptr},
+                                false)};
+    get_(Id::stvarSuper) = {
+        "stvarSuper", (void*)&stvarSuperImpl,
+        llvm::FunctionType::get(t::Void,
+                                {t::SEXP, t::SEXP, t::SEXP, t::voidPtr},
+                                false)};
     get_(Id::stvar) = {"stvar", (void*)&stvarImpl, t::void_sexpsexpsexp};
     get_(Id::stvari) = {
         "stvari", (void*)&stvarImplI,
@@ -2328,7 +2469,11 @@ void NativeBuiltins::initializeBuiltins() {
         (void*)&externalsxpSetEntryImpl,
         llvm::FunctionType::get(t::t_void, {t::SEXP, t::Int, t::SEXP}, false),
         {llvm::Attribute::ArgMemOnly}};
-    get_(Id::defvar) = {"defvar", (void*)&defvarImpl, t::void_sexpsexpsexp};
+    get_(Id::defvar) = {
+        "defvar", (void*)&defvarImpl,
+        llvm::FunctionType::get(t::Void,
+                                {t::SEXP, t::SEXP, t::SEXP, t::voidPtr},
+                                false)};
     get_(Id::ldfun) = {"ldfun", (void*)&ldfunImpl, t::sexp_sexpsexp};
     get_(Id::chkfun) = {"chkfun", (void*)&chkfunImpl, t::sexp_sexpsexp};
     get_(Id::warn) = {"warn", (void*)&warnImpl,
@@ -2484,6 +2629,15 @@ void NativeBuiltins::initializeBuiltins() {
                                 {t::i64, t::voidPtr, t::SEXP, t::Int, t::Int,
                                  t::SEXP, t::i64, t::i64, t::Int},
                                 false)};
+    get_(Id::nativeSelfCall) = {
+        "nativeSelfCall", (void*)&nativeSelfCallImpl,
+        llvm::FunctionType::get(
+            t::SEXP,
+            {t::i64, t::voidPtr, t::SEXP, t::Int, t::SEXP, t::i64, t::i64},
+            false)};
+    get_(Id::boxStackArg) = {
+        "boxStackArg", (void*)&ostack_box_cell,
+        llvm::FunctionType::get(t::SEXP, {t::stackCellPtr}, false)};
     get_(Id::subassign11) = {
         "subassign1_1D", (void*)subassign11Impl,
         llvm::FunctionType::get(
@@ -2553,7 +2707,8 @@ void NativeBuiltins::initializeBuiltins() {
         "initClosureContext", (void*)&initClosureContextImpl,
         llvm::FunctionType::get(t::t_void,
                                 {t::i64, t::voidPtr, t::SEXP, t::RCNTXT_ptr,
-                                 t::SEXP, t::SEXP, t::i64},
+                                 t::SEXP, t::SEXP, t::i64, t::stackCellPtr,
+                                 t::voidPtr},
                                 false)};
     get_(Id::endClosureContext) = {
         "endClosureContext", (void*)&endClosureContextImpl,
@@ -43,7 +43,9 @@ struct NativeBuiltins {
         ldvarForUpdate,
         ldvar,
         ldvarGlobal,
+        ldvarSuper,
         ldvarCacheMiss,
+        stvarCacheMiss,
         stvarSuper,
         stvar,
         stvari,
@@ -99,6 +101,8 @@ struct NativeBuiltins {
         extract22ii,
         extract22rr,
         nativeCallTrampoline,
+        nativeSelfCall,
+        boxStackArg,
         subassign11,
         setVecElt,
         subassign21,
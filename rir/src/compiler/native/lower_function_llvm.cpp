@@ -13,10 +13,13 @@
 #include "compiler/util/visitor.h"
 #include "interpreter/builtins.h"
 #include "interpreter/instance.h"
+#include "interpreter/opcode_stats.h"
 #include "interpreter/profiler.h"
 #include "runtime/DispatchTable.h"
+#include "runtime/LazyArglist.h"
 #include "runtime/LazyEnvironment.h"
 #include "utils/Pool.h"
+#include "utils/measuring.h"
 
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/Intrinsics.h"
@@ -264,6 +267,12 @@ void LowerFunctionLLVM::stack(const std::vector<llvm::Value*>& args) {
     for (auto arg = args.begin(); arg != args.end(); arg++) {
         // store the value
         auto valS = builder.CreateGEP(stackptr, {c(pos), c(2)});
+        auto ty = (*arg)->getType();
+        if (ty == t::Int || ty == t::Double) {
+            builder.CreateStore(c(ty == t::Int ? INTSXP : REALSXP),
+                                builder.CreateGEP(stackptr, {c(pos), c(0)}));
+            valS = builder.CreateBitCast(valS, PointerType::get(ty, 0));
+        }
         builder.CreateStore(*arg, valS);
         pos++;
     }
@@ -300,7 +309,10 @@ llvm::Value* LowerFunctionLLVM::callRBuiltin(SEXP builtin,
                                              const std::vector<Value*>& args,
                                              int srcIdx, CCODE builtinFun,
                                              llvm::Value* env) {
-    if (supportsFastBuiltinCall(builtin, args.size())) {
+    // Calling through the runtime avoids allocating the arglist, unless the
+    // builtin actually needs it or dispatches on an object
+    if (supportsFastBuiltinCall(builtin, args.size()) ||
+        supportsFastBuiltinCall2(builtin, args.size())) {
         return withCallFrame(args, [&]() -> llvm::Value* {
             return call(NativeBuiltins::get(NativeBuiltins::Id::callBuiltin),
                         {
@@ -356,12 +368,25 @@ llvm::Value* LowerFunctionLLVM::callRBuiltin(SEXP builtin,
 llvm::Value*
 LowerFunctionLLVM::withCallFrame(const std::vector<Value*>& args,
                                  const std::function<llvm::Value*()>& theCall,
-                                 bool pop) {
+                                 bool pop, const Context* unboxedIn) {
     auto nargs = args.size();
     incStack(nargs, false);
     std::vector<llvm::Value*> jitArgs;
-    for (auto& arg : args)
-        jitArgs.push_back(load(arg, Rep::SEXP));
+    for (size_t i = 0; i < nargs; ++i) {
+        // Scalars the callee expects as such are passed in tagged cells,
+        // without allocating a box for them
+        auto arg = args[i];
+        if (unboxedIn && Rep::Of(arg) == Rep::i32 &&
+            arg->type.isA(PirType::simpleScalarInt()) &&
+            unboxedIn->isSimpleInt(i))
+            jitArgs.push_back(load(arg, Rep::i32));
+        else if (unboxedIn && Rep::Of(arg) == Rep::f64 &&
+                 arg->type.isA(PirType::simpleScalarReal()) &&
+                 unboxedIn->isSimpleReal(i))
+            jitArgs.push_back(load(arg, Rep::f64));
+        else
+            jitArgs.push_back(load(arg, Rep::SEXP));
+    }
     stack(jitArgs);
     auto res = theCall();
     if (pop)
@@ -390,7 +415,13 @@ llvm::Value* LowerFunctionLLVM::load(Value* val, PirType type, Rep needed) {
     }
 
     if (auto a = LdArg::Cast(val)) {
-        res = argument(a->pos);
+        if (unboxedArgumentType(a->pos))
+            res = unboxedArgument(a->pos, needed == Rep::SEXP);
+        else
+            res = argument(a->pos);
+    } else if (inFrame(val)) {
+        // Frame environments are only loaded when deoptimizing
+        res = materializeFrameEnv(MkEnv::Cast(val));
     } else if (vali && variables_.count(vali)) {
         res = getVariable(vali);
     } else if (val == Env::elided()) {
@@ -505,13 +536,69 @@ llvm::Value* LowerFunctionLLVM::load(Value* val, PirType type, Rep needed) {
     return res;
 }
 
+// If index is the induction variable of a counted loop (see
+// InductionVariables), returns an i1 which holds iff it stays within bounds of
+// vector for the whole loop. The test is loop invariant and emitted once at the
+// end of the preheader, which is already lowered at this point. The bounds
+// checks stay in place, but are only taken if it fails, such that llvm can
+// unswitch the loop on it and drop them from the hot version.
+llvm::Value* LowerFunctionLLVM::inductionVariableInBounds(Value* index,
+                                                          Value* vector) {
+    auto iv = inductionVariables.at(index, currentBB);
+    if (!iv || !iv->preheader)
+        return nullptr;
+    auto preheaderEnd = blockEnd.find(iv->preheader);
+    if (preheaderEnd == blockEnd.end() ||
+        !preheaderEnd->second->getTerminator())
+        return nullptr;
+    auto vec = inductionVariables.sameLengthInvariant(*iv, vector);
+    if (!vec || Rep::Of(vec) != Rep::SEXP || !vectorTypeSupport(vec))
+        return nullptr;
+
+    auto& guard = inductionVariableGuards[iv->phi][vec];
+    if (guard)
+        return guard;
+
+    auto ip = builder.saveIP();
+    builder.SetInsertPoint(preheaderEnd->second->getTerminator());
+
+    auto init = builder.CreateSExt(load(iv->init, Rep::i32), t::i64);
+    auto end = builder.CreateSExt(load(iv->end, Rep::i32), t::i64);
+    auto ascending = builder.CreateICmpSLE(init, end);
+    auto descending = builder.CreateICmpSGE(init, end);
+    auto lower =
+        builder.CreateSelect(ascending, init, builder.CreateAdd(end, c(1l)));
+    auto upper =
+        builder.CreateSelect(descending, init, builder.CreateSub(end, c(1l)));
+
+    auto v = load(vec, Rep::SEXP);
+    guard = builder.CreateAnd(
+        builder.CreateNot(isAltrep(v)),
+        builder.CreateAnd(builder.CreateICmpSGE(lower, c(1l)),
+                          builder.CreateICmpSLE(upper, vectorLength(v))));
+    if (!iv->wellFormed) {
+        auto step = load(iv->step, Rep::i32);
+        guard = builder.CreateAnd(
+            guard, builder.CreateSelect(builder.CreateICmpSGT(step, c(0)),
+                                        ascending, descending));
+    }
+
+    builder.restoreIP(ip);
+    return guard;
+}
+
 llvm::Value* LowerFunctionLLVM::computeAndCheckIndex(Value* index,
                                                      llvm::Value* vector,
                                                      BasicBlock* fallback,
-                                                     llvm::Value* max) {
+                                                     llvm::Value* max,
+                                                     Value* pirVector) {
     BasicBlock* hit1 = BasicBlock::Create(PirJitLLVM::getContext(), "", fun);
     BasicBlock* hit = BasicBlock::Create(PirJitLLVM::getContext(), "", fun);
 
+    llvm::Value* inBounds = nullptr;
+    if (pirVector && !max && vector->getType() == t::SEXP)
+        inBounds = inductionVariableInBounds(index, pirVector);
+
     auto representation = Rep::Of(index);
     llvm::Value* nativeIndex = load(index);
 
@@ -541,7 +628,9 @@ llvm::Value* LowerFunctionLLVM::computeAndCheckIndex(Value* index,
         assert(representation == Rep::i32);
         auto indexUnderRange = builder.CreateICmpSLT(nativeIndex, c(1));
         auto indexNa = builder.CreateICmpEQ(nativeIndex, c(NA_INTEGER));
-        auto fail = builder.CreateOr(indexUnderRange, indexNa);
+        llvm::Value* fail = builder.CreateOr(indexUnderRange, indexNa);
+        if (inBounds)
+            fail = builder.CreateAnd(builder.CreateNot(inBounds), fail);
 
         builder.CreateCondBr(fail, fallback, hit1, branchMostlyFalse);
         builder.SetInsertPoint(hit1);
@@ -555,7 +644,10 @@ llvm::Value* LowerFunctionLLVM::computeAndCheckIndex(Value* index,
     assert(ty == t::SEXP || ty == t::Int || ty == t::Double);
     if (!max)
         max = (ty == t::SEXP) ? vectorLength(vector) : c(1ul);
-    auto indexOverRange = builder.CreateICmpUGE(nativeIndex, max);
+    llvm::Value* indexOverRange = builder.CreateICmpUGE(nativeIndex, max);
+    if (inBounds)
+        indexOverRange =
+            builder.CreateAnd(builder.CreateNot(inBounds), indexOverRange);
     builder.CreateCondBr(indexOverRange, fallback, hit, branchMostlyFalse);
     builder.SetInsertPoint(hit);
     return nativeIndex;
@@ -592,6 +684,44 @@ void LowerFunctionLLVM::compilePopContext(Instruction* i) {
     setVal(i, Rep::Of(i) == Rep::SEXP ? boxedRet : ret);
 }
 
+// Jumps into an inlined context are non-local returns to it, restarts and
+// on.exit handlers. All of them need some R code to run inside the context.
+// Deopts do not jump here, they set up the inlined contexts again.
+static bool canBeJumpedTo(PushContext* push) {
+    std::unordered_set<BB*> visited;
+    std::vector<BB*> todo = {push->bb()};
+    bool jumpedTo = false;
+    while (!todo.empty() && !jumpedTo) {
+        auto bb = todo.back();
+        todo.pop_back();
+        auto it = bb == push->bb() ? bb->atPosition(push) + 1 : bb->begin();
+        bool left = false;
+        for (; it != bb->end() && !jumpedTo; ++it) {
+            auto i = *it;
+            if (auto pop = PopContext::Cast(i)) {
+                if (pop->push() == push) {
+                    left = true;
+                    break;
+                }
+            }
+            if (NonLocalReturn::Cast(i))
+                jumpedTo = true;
+            else if (Branch::Cast(i) &&
+                     i->arg(0).val() == OpaqueTrue::instance())
+                jumpedTo = true;
+            else if (!Deopt::Cast(i) &&
+                     i->effects.contains(Effect::ExecuteCode))
+                jumpedTo = true;
+        }
+        if (left)
+            continue;
+        for (auto suc : bb->successors())
+            if (visited.insert(suc).second)
+                todo.push_back(suc);
+    }
+    return jumpedTo;
+}
+
 void LowerFunctionLLVM::compilePushContext(Instruction* i) {
     auto ct = PushContext::Cast(i);
     auto ast = loadSxp(ct->ast());
@@ -612,15 +742,15 @@ void LowerFunctionLLVM::compilePushContext(Instruction* i) {
     if (ct->isReordered())
         callId = pushArgReordering(ct->getArgOrderOrig());
 
-    withCallFrame(
-        arglist,
-        [&]() -> llvm::Value* {
-            return call(
-                NativeBuiltins::get(NativeBuiltins::Id::initClosureContext),
-                {c(callId), paramCode(), ast, data.rcntxt, sysparent, op,
-                 c(ct->narglist())});
-        },
-        false);
+    for (size_t j = 0; j < arglist.size(); ++j)
+        setLocal(data.argsPos + j, loadSxp(arglist[j]));
+    call(NativeBuiltins::get(NativeBuiltins::Id::initClosureContext),
+         {c(callId), paramCode(), ast, data.rcntxt, sysparent, op,
+          c(ct->narglist()), builder.CreateGEP(basepointer, c(data.argsPos)),
+          builder.CreateBitCast(data.arglist, t::voidPtr)});
+
+    if (!data.needsSetjmp)
+        return;
 
     // Create a copy of all live variables to be able to restart
     // SEXPs are stored as local vars, primitive values are placed in an
@@ -880,6 +1010,51 @@ llvm::Value* LowerFunctionLLVM::argument(int i) {
     return argument(i);
 }
 
+SEXPTYPE LowerFunctionLLVM::unboxedArgumentType(int i) {
+    if (code != cls || cls->isContinuation())
+        return 0;
+    auto& context = cls->context();
+    if (context.isSimpleInt(i))
+        return INTSXP;
+    if (context.isSimpleReal(i))
+        return REALSXP;
+    return 0;
+}
+
+// Native callers pass scalar arguments unboxed in tagged cells, if our context
+// says they are simple scalars (see withCallFrame). Unlike argument, this
+// cannot be loaded once on entry, since boxing writes the cell back.
+llvm::Value* LowerFunctionLLVM::unboxedArgument(int i, bool boxed) {
+    auto type = unboxedArgumentType(i);
+    assert(type == INTSXP || type == REALSXP);
+    auto cell = builder.CreateGEP(paramArgs(), c(i));
+    auto tag = builder.CreateLoad(builder.CreateGEP(cell, {c(0), c(0)}));
+    auto pos = builder.CreateGEP(cell, {c(0), c(2)});
+    auto isBoxed = builder.CreateICmpEQ(tag, c(0));
+
+    if (boxed) {
+        return createSelect2(
+            isBoxed, [&]() { return builder.CreateLoad(pos); },
+            [&]() {
+                return call(
+                    NativeBuiltins::get(NativeBuiltins::Id::boxStackArg),
+                    {cell});
+            });
+    }
+
+    auto llvmType = type == INTSXP ? t::Int : t::Double;
+    return createSelect2(
+        isBoxed,
+        [&]() {
+            auto arg = builder.CreateLoad(pos);
+            return type == INTSXP ? unboxInt(arg) : unboxReal(arg);
+        },
+        [&]() {
+            return builder.CreateLoad(
+                builder.CreateBitCast(pos, PointerType::get(llvmType, 0)));
+        });
+}
+
 AllocaInst* LowerFunctionLLVM::topAlloca(llvm::Type* t, size_t len) {
     auto cur = builder.GetInsertBlock();
     builder.SetInsertPoint(entryBlock);
@@ -1425,6 +1600,19 @@ llvm::Value* LowerFunctionLLVM::container(llvm::Value* v) {
 
 llvm::CallInst* LowerFunctionLLVM::call(const NativeBuiltin& builtin,
                                         const std::vector<llvm::Value*>& args) {
+#ifdef RIR_OPCODE_STATS
+    // Some callers pass a copy, thus look the builtin up by its function
+    size_t id = 0;
+    auto first = &NativeBuiltins::get(NativeBuiltins::Id::FIRST);
+    NativeBuiltins::eachBuiltin([&](const NativeBuiltin& b) {
+        if (b.fun == builtin.fun)
+            id = &b - first;
+    });
+    auto counter =
+        convertToPointer(&OpcodeStats::nativeBuiltins[id], t::i64, false);
+    builder.CreateStore(builder.CreateAdd(builder.CreateLoad(counter), c(1UL)),
+                        counter);
+#endif
     return builder.CreateCall(getBuiltin(builtin), args);
 }
 
@@ -1959,6 +2147,105 @@ void LowerFunctionLLVM::envStubSet(llvm::Value* x, int i, llvm::Value* y,
     }
 }
 
+llvm::Value* LowerFunctionLLVM::envStubNames(MkEnv* env) {
+    std::vector<BC::PoolIdx> names;
+    for (size_t i = 0; i < env->nLocals(); ++i) {
+        auto n = env->varName[i];
+        if (env->missing[i])
+            n = CONS_NR(n, R_NilValue);
+        names.push_back(Pool::insert(n));
+    }
+    return builder.CreateBitCast(globalConst(c(names)), t::IntPtr);
+}
+
+void LowerFunctionLLVM::computeFrameEnvironments() {
+    // A stub escapes unless it is only ever the environment of instructions
+    // accessing its bindings. Frame states leak it only when deoptimizing,
+    // which is where we create the actual stub.
+    std::vector<MkEnv*> stubs;
+    std::unordered_set<MkEnv*> escaping;
+    Visitor::run(code->entry, [&](Instruction* i) {
+        if (auto mk = MkEnv::Cast(i))
+            if (mk->stub)
+                stubs.push_back(mk);
+
+        bool accessesBindings = LdVar::Cast(i) || StVar::Cast(i) ||
+                                LdVarSuper::Cast(i) || IsEnvStub::Cast(i) ||
+                                FrameState::Cast(i);
+        i->eachArg([&](Value* v) {
+            auto mk = MkEnv::Cast(v);
+            if (mk && (!accessesBindings || i->env() != mk))
+                escaping.insert(mk);
+        });
+        if (auto st = StVar::Cast(i)) {
+            if (auto mk = MkEnv::Cast(st->val()))
+                escaping.insert(mk);
+        } else if (auto fs = FrameState::Cast(i)) {
+            for (size_t pos = 0; pos < fs->stackSize; pos++)
+                if (auto mk = MkEnv::Cast(fs->arg(pos).val()))
+                    escaping.insert(mk);
+        }
+    });
+
+    // One slot per binding, followed by the parent
+    for (auto mk : stubs) {
+        if (escaping.count(mk))
+            continue;
+        frameEnvironments[mk] = {numLocals, topAlloca(t::i8, mk->nLocals()),
+                                 0};
+        numLocals += mk->nLocals() + 1;
+    }
+}
+
+bool LowerFunctionLLVM::inFrame(Value* env) {
+    auto mk = MkEnv::Cast(env);
+    return mk && frameEnvironments.count(mk);
+}
+
+llvm::Value* LowerFunctionLLVM::frameEnvSlot(MkEnv* env, int i) {
+    auto pos = frameEnvironments.at(env).pos + i;
+    return builder.CreateGEP(basepointer, {c(pos), c(2)});
+}
+
+llvm::Value* LowerFunctionLLVM::frameEnvMissing(MkEnv* env, int i) {
+    return builder.CreateGEP(frameEnvironments.at(env).missing, c(i));
+}
+
+llvm::Value* LowerFunctionLLVM::materializeFrameEnv(MkEnv* env) {
+    // The deopt sequence is straight line code, thus the first stub
+    // dominates all later loads
+    if (materializedFrameEnvs) {
+        auto done = materializedFrameEnvs->find(env);
+        if (done != materializedFrameEnvs->end())
+            return done->second;
+    }
+
+    auto& f = frameEnvironments.at(env);
+    auto size = env->nLocals();
+    // Contexts pushed since the environment was created come first
+    int context = env->context ? env->context + inPushContext - f.contextDepth
+                               : 0;
+    auto res = call(
+        NativeBuiltins::get(NativeBuiltins::Id::createStubEnvironment),
+        {builder.CreateLoad(frameEnvSlot(env, size)), c((int)size),
+         envStubNames(env), c(context)});
+    protectTemp(res);
+    if (materializedFrameEnvs)
+        (*materializedFrameEnvs)[env] = res;
+
+    auto le = builder.CreateBitCast(dataPtr(res, false),
+                                    PointerType::get(t::LazyEnvironment, 0));
+    auto missingBits =
+        builder.CreateBitCast(builder.CreateGEP(le, c(1)), t::i8ptr);
+    for (size_t i = 0; i < size; ++i) {
+        envStubSet(res, i, builder.CreateLoad(frameEnvSlot(env, i)), size,
+                   false);
+        builder.CreateStore(builder.CreateLoad(frameEnvMissing(env, i)),
+                            builder.CreateGEP(missingBits, c(i)));
+    }
+    return res;
+}
+
 llvm::Value* LowerFunctionLLVM::isObj(llvm::Value* v) {
     checkIsSexp(v, "in IsObj");
     auto sxpinfo = builder.CreateLoad(sxpinfoPtr(v));
@@ -2147,11 +2434,15 @@ void LowerFunctionLLVM::compile() {
 
     std::unordered_map<Instruction*, Instruction*> phis;
     {
+        computeFrameEnvironments();
+
         NativeAllocator allocator(code, liveness);
         auto numLocalsBase = numLocals;
         numLocals += allocator.slots();
 
         auto createVariable = [&](Instruction* i, bool mut) -> void {
+            if (inFrame(i))
+                return;
             if (Rep::Of(i) == Rep::SEXP) {
                 if (mut)
                     variables_[i] = Variable::MutableRVariable(
@@ -2204,10 +2495,25 @@ void LowerFunctionLLVM::compile() {
                     resRep = Rep::Of(pop);
                 auto resStore = topAlloca(resRep.toLlvm());
                 auto rcntxt = topAlloca(t::RCNTXT);
+                auto arglist = topAlloca(
+                    t::i64, sizeof(LazyArglistOnStack) / sizeof(int64_t) + 1);
+                auto needsSetjmp = canBeJumpedTo(push);
                 contexts[push] = {
-                    rcntxt, resStore,
+                    rcntxt,
+                    resStore,
                     pop ? BasicBlock::Create(PirJitLLVM::getContext(), "", fun)
-                        : nullptr};
+                        : nullptr,
+                    numLocals,
+                    arglist,
+                    needsSetjmp};
+                numLocals += push->narglist();
+                if (Parameter::MEASURE_CONTEXTS) {
+                    Measuring::countEvent("contexts in native code");
+                    if (!needsSetjmp)
+                        Measuring::countEvent("contexts without setjmp");
+                }
+                if (!needsSetjmp)
+                    return;
 
                 // Everything which is live at the Push context needs to be
                 // mutable, to be able to restore on restart
@@ -3421,6 +3727,23 @@ void LowerFunctionLLVM::compile() {
                     break;
                 }
 
+                // Recursive calls of this version do not need to dispatch,
+                // the arguments already satisfy our own context
+                if (target == cls && code == cls && !cls->isContinuation()) {
+                    auto selfCall = [&]() -> llvm::Value* {
+                        return call(
+                            NativeBuiltins::get(
+                                NativeBuiltins::Id::nativeSelfCall),
+                            {c(callId), paramCode(),
+                             constant(target->owner()->rirClosure(), t::SEXP),
+                             c(calli->srcIdx), loadSxp(calli->env()),
+                             c(args.size()), c(asmpt.toI())});
+                    };
+                    setVal(i, withCallFrame(args, selfCall, true,
+                                            &cls->context()));
+                    break;
+                }
+
                 if (target == bestTarget) {
                     auto callee = target->owner()->rirClosure();
                     auto dt = DispatchTable::check(BODY(callee));
@@ -3444,7 +3767,7 @@ void LowerFunctionLLVM::compile() {
                         new (DATAPTR(missAsmptStore))
                             Context(nativeTarget->context() - asmpt);
                         assert(asmpt.smaller(nativeTarget->context()));
-                        auto res = withCallFrame(args, [&]() {
+                        auto trampoline = [&]() -> llvm::Value* {
                             return call(
                                 NativeBuiltins::get(
                                     NativeBuiltins::Id::nativeCallTrampoline),
@@ -3459,8 +3782,12 @@ void LowerFunctionLLVM::compile() {
                                     c(asmpt.toI()),
                                     c(missAsmptIdx),
                                 });
-                        });
-                        setVal(i, res);
+                        };
+                        // The target reads the scalar args of its context
+                        // unboxed, the trampoline boxes them if it changes
+                        auto targetContext = nativeTarget->context();
+                        setVal(i, withCallFrame(args, trampoline, true,
+                                                &targetContext));
                         break;
                     }
                 }
@@ -3582,6 +3909,13 @@ void LowerFunctionLLVM::compile() {
                     target->addExtraPoolEntry(store);
                 }
 
+                // The interpreter reads our arguments as SEXPs
+                for (size_t i = 0; i < cls->nargs(); ++i)
+                    if (unboxedArgumentType(i))
+                        unboxedArgument(i, true);
+
+                std::unordered_map<MkEnv*, llvm::Value*> frameEnvs;
+                materializedFrameEnvs = &frameEnvs;
                 withCallFrame(args, [&]() {
                     return call(NativeBuiltins::get(NativeBuiltins::Id::deopt),
                                 {paramCode(), paramClosure(),
@@ -3590,6 +3924,7 @@ void LowerFunctionLLVM::compile() {
                                  load(deopt->deoptReason()),
                                  loadSxp(deopt->deoptTrigger())});
                 });
+                materializedFrameEnvs = nullptr;
                 builder.CreateUnreachable();
                 break;
             }
@@ -3598,23 +3933,34 @@ void LowerFunctionLLVM::compile() {
                 auto mkenv = MkEnv::Cast(i);
                 auto parent = loadSxp(mkenv->env());
 
-                std::vector<BC::PoolIdx> names;
-                for (size_t i = 0; i < mkenv->nLocals(); ++i) {
-                    auto n = mkenv->varName[i];
-                    if (mkenv->missing[i])
-                        n = CONS_NR(n, R_NilValue);
-                    names.push_back(Pool::insert(n));
+                if (inFrame(mkenv)) {
+                    frameEnvironments.at(mkenv).contextDepth = inPushContext;
+                    builder.CreateStore(
+                        parent, frameEnvSlot(mkenv, mkenv->nLocals()));
+                    size_t pos = 0;
+                    mkenv->eachLocalVar([&](SEXP name, Value* v, bool miss) {
+                        auto vn = loadSxp(v);
+                        builder.CreateStore(vn, frameEnvSlot(mkenv, pos));
+                        llvm::Value* isMissing = c(miss ? 1 : 0, 8);
+                        if (!miss && v->type.maybeMissing())
+                            isMissing = builder.CreateZExt(
+                                builder.CreateICmpEQ(
+                                    vn, constant(R_MissingArg, Rep::SEXP)),
+                                t::i8);
+                        builder.CreateStore(isMissing,
+                                            frameEnvMissing(mkenv, pos));
+                        pos++;
+                        incrementNamed(vn);
+                    });
+                    break;
                 }
-                auto namesConst = c(names);
-                auto namesStore = globalConst(namesConst);
 
                 if (mkenv->stub) {
                     auto env =
                         call(NativeBuiltins::get(
                                  NativeBuiltins::Id::createStubEnvironment),
                              {parent, c((int)mkenv->nLocals()),
-                              builder.CreateBitCast(namesStore, t::IntPtr),
-                              c(mkenv->context)});
+                              envStubNames(mkenv), c(mkenv->context)});
                     protectTemp(env);
                     size_t pos = 0;
                     mkenv->eachLocalVar([&](SEXP name, Value* v, bool miss) {
@@ -4305,6 +4651,12 @@ void LowerFunctionLLVM::compile() {
             }
 
             case Tag::IsEnvStub: {
+                // Frame environments are only materialized when deoptimizing
+                if (inFrame(i->env())) {
+                    setVal(i, constant(R_TrueValue, Rep::Of(i)));
+                    break;
+                }
+
                 auto arg = loadSxp(i->arg(0).val());
                 auto env = MkEnv::Cast(i->env());
 
@@ -4820,8 +5172,9 @@ void LowerFunctionLLVM::compile() {
                 else
                     env = envsxpEnclos(loadSxp(ld->env()));
 
-                auto res = call(NativeBuiltins::get(NativeBuiltins::Id::ldvar),
-                                {constant(ld->varName, t::SEXP), env});
+                auto res =
+                    call(NativeBuiltins::get(NativeBuiltins::Id::ldvarSuper),
+                         {constant(ld->varName, t::SEXP), env, paramCode()});
                 res->setName(CHAR(PRINTNAME(ld->varName)));
 
                 checkMissing(res);
@@ -4842,8 +5195,13 @@ void LowerFunctionLLVM::compile() {
                 bool maybeUnbound = true;
                 llvm::Value* res;
                 if (env && env->stub) {
-                    auto e = loadSxp(env);
-                    res = envStubGet(e, env->indexOf(varName), env->nLocals());
+                    auto frameEnv = inFrame(env);
+                    auto e = frameEnv ? nullptr : loadSxp(env);
+                    auto idx = env->indexOf(varName);
+                    if (frameEnv)
+                        res = builder.CreateLoad(frameEnvSlot(env, idx));
+                    else
+                        res = envStubGet(e, idx, env->nLocals());
                     if (env->argNamed(varName).val() !=
                         UnboundValue::instance()) {
                         maybeUnbound = false;
@@ -4853,11 +5211,15 @@ void LowerFunctionLLVM::compile() {
                                 res, constant(R_UnboundValue, t::SEXP)),
                             // if unsassigned in the stub, fall through
                             [&]() {
-                                return call(
-                                    NativeBuiltins::get(
-                                        NativeBuiltins::Id::ldvar),
-                                    {constant(varName, t::SEXP),
-                                     envStubGet(e, -1, env->nLocals())});
+                                auto parent =
+                                    frameEnv
+                                        ? builder.CreateLoad(frameEnvSlot(
+                                              env, env->nLocals()))
+                                        : envStubGet(e, -1, env->nLocals());
+                                return call(NativeBuiltins::get(
+                                                NativeBuiltins::Id::ldvar),
+                                            {constant(varName, t::SEXP),
+                                             parent});
                             },
                             [&]() { return res; });
                     }
@@ -4994,7 +5356,8 @@ void LowerFunctionLLVM::compile() {
                     }
 
                     llvm::Value* index =
-                        computeAndCheckIndex(extract->idx(), vector, fallback);
+                        computeAndCheckIndex(extract->idx(), vector, fallback,
+                                             nullptr, extract->vec());
                     auto res0 =
                         extract->vec()->type.isScalar()
                             ? vector
@@ -5140,7 +5503,8 @@ void LowerFunctionLLVM::compile() {
                     }
 
                     llvm::Value* index =
-                        computeAndCheckIndex(extract->idx(), vector, fallback);
+                        computeAndCheckIndex(extract->idx(), vector, fallback,
+                                             nullptr, extract->vec());
                     auto res0 =
                         extract->vec()->type.isScalar()
                             ? vector
@@ -5515,8 +5879,9 @@ void LowerFunctionLLVM::compile() {
                         vector = cloneIfShared(vector);
                     }
 
-                    llvm::Value* index = computeAndCheckIndex(subAssign->idx(),
-                                                              vector, fallback);
+                    llvm::Value* index =
+                        computeAndCheckIndex(subAssign->idx(), vector, fallback,
+                                             nullptr, subAssign->vec());
 
                     auto val = load(subAssign->val());
                     if (Rep::Of(i) == Rep::SEXP) {
@@ -5604,8 +5969,9 @@ void LowerFunctionLLVM::compile() {
                         vector = cloneIfShared(vector);
                     }
 
-                    llvm::Value* index = computeAndCheckIndex(subAssign->idx(),
-                                                              vector, fallback);
+                    llvm::Value* index =
+                        computeAndCheckIndex(subAssign->idx(), vector, fallback,
+                                             nullptr, subAssign->vec());
 
                     auto val = load(subAssign->val());
                     if (Rep::Of(i) == Rep::SEXP) {
@@ -5676,10 +6042,35 @@ void LowerFunctionLLVM::compile() {
 
                 if (environment && environment->stub) {
                     auto idx = environment->indexOf(st->varName);
-                    auto e = loadSxp(environment);
+                    auto frameEnv = inFrame(environment);
+                    auto e = frameEnv ? nullptr : loadSxp(environment);
+                    auto setNotMissing = [&]() {
+                        if (frameEnv)
+                            builder.CreateStore(
+                                c(0, 8), frameEnvMissing(environment, idx));
+                        else
+                            envStubSetNotMissing(e, idx);
+                    };
+                    auto set = [&](llvm::Value* val) {
+                        if (!frameEnv) {
+                            envStubSet(e, idx, val, environment->nLocals(),
+                                       !st->isStArg);
+                            return;
+                        }
+                        builder.CreateStore(val,
+                                            frameEnvSlot(environment, idx));
+                        if (!st->isStArg)
+                            setNotMissing();
+                    };
+
                     BasicBlock* done =
                         BasicBlock::Create(PirJitLLVM::getContext(), "", fun);
-                    auto cur = envStubGet(e, idx, environment->nLocals());
+                    llvm::Value* cur;
+                    if (frameEnv)
+                        cur = builder.CreateLoad(
+                            frameEnvSlot(environment, idx));
+                    else
+                        cur = envStubGet(e, idx, environment->nLocals());
 
                     if (Rep::Of(st->val()) != Rep::SEXP) {
                         auto fastcase = BasicBlock::Create(
@@ -5716,18 +6107,16 @@ void LowerFunctionLLVM::compile() {
 
                             builder.SetInsertPoint(same);
                             ensureNamed(val);
-                            envStubSetNotMissing(e, idx);
+                            setNotMissing();
                             builder.CreateBr(done);
 
                             builder.SetInsertPoint(different);
                         }
                         incrementNamed(val);
-                        envStubSet(e, idx, val, environment->nLocals(),
-                                   !st->isStArg);
+                        set(val);
                     } else {
                         ensureNamed(val);
-                        envStubSet(e, idx, val, environment->nLocals(),
-                                   !st->isStArg);
+                        set(val);
                     }
 
                     builder.CreateBr(done);
@@ -5841,10 +6230,17 @@ void LowerFunctionLLVM::compile() {
                     builder.CreateBr(done);
 
                     builder.SetInsertPoint(miss);
-                    llvm::Value* theValue =
-                        unboxed ? load(pirVal) : loadSxp(pirVal);
-                    call(setter, {constant(st->varName, t::SEXP), theValue,
-                                  loadSxp(st->env())});
+                    if (st->isStArg) {
+                        call(setter, {constant(st->varName, t::SEXP),
+                                      loadSxp(pirVal), loadSxp(st->env())});
+                    } else {
+                        // Defining the variable fills the cache, such that
+                        // the next store or load does not search the frame
+                        call(NativeBuiltins::get(
+                                 NativeBuiltins::Id::stvarCacheMiss),
+                             {constant(st->varName, t::SEXP), loadSxp(pirVal),
+                              loadSxp(st->env()), cachePtr});
+                    }
                     builder.CreateBr(done);
 
                     builder.SetInsertPoint(done);
@@ -5867,7 +6263,8 @@ void LowerFunctionLLVM::compile() {
                         call(
                             NativeBuiltins::get(NativeBuiltins::Id::stvarSuper),
                             {constant(st->varName, t::SEXP),
-                             loadSxp(st->arg<0>().val()), loadSxp(st->env())});
+                             loadSxp(st->arg<0>().val()), loadSxp(st->env()),
+                             paramCode()});
                         break;
                     }
                 }
@@ -5876,7 +6273,8 @@ void LowerFunctionLLVM::compile() {
                 // super assigns to standard stores
                 call(NativeBuiltins::get(NativeBuiltins::Id::defvar),
                      {constant(st->varName, t::SEXP),
-                      loadSxp(st->arg<0>().val()), loadSxp(st->env())});
+                      loadSxp(st->arg<0>().val()), loadSxp(st->env()),
+                      paramCode()});
                 break;
             }
 
@@ -6207,6 +6605,7 @@ void LowerFunctionLLVM::compile() {
 
         if (bb->isJmp())
             builder.CreateBr(getBlock(bb->next()));
+        blockEnd[bb] = builder.GetInsertBlock();
 
         for (auto suc : bb->successors())
             blockInPushContext[suc] = inPushContext;
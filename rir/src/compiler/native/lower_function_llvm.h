@@ -2,6 +2,7 @@
 #define PIR_COMPILER_LOWER_FUNCTION_LLVM_H
 
 #include "R/Protect.h"
+#include "compiler/analysis/induction_variables.h"
 #include "compiler/analysis/liveness.h"
 #include "compiler/analysis/reference_count.h"
 #include "compiler/native/builtins.h"
@@ -38,6 +39,7 @@ class LowerFunctionLLVM {
     llvm::IRBuilder<> builder;
     llvm::MDBuilder MDB;
     LivenessIntervals liveness;
+    InductionVariables inductionVariables;
     size_t numLocals;
     size_t numTemps;
     size_t maxTemps;
@@ -51,10 +53,37 @@ class LowerFunctionLLVM {
         llvm::AllocaInst* rcntxt;
         llvm::AllocaInst* result;
         llvm::BasicBlock* popContextTarget;
+        // The arguments are kept in frame slots, the arglist in an alloca
+        size_t argsPos;
+        llvm::AllocaInst* arglist;
+        // Only contexts which can be the target of a longjmp need a setjmp,
+        // and the copies of live values to restart from
+        bool needsSetjmp;
         std::unordered_map<Instruction*, size_t> savedSexpPos;
     };
     std::unordered_map<Value*, ContextData> contexts;
 
+    // Stub environments which cannot escape the native frame. Their bindings
+    // live in slots of our node stack frame, a heap stub is only created if we
+    // deoptimize (see computeFrameEnvironments).
+    struct FrameEnvironment {
+        size_t pos;
+        llvm::AllocaInst* missing;
+        int contextDepth;
+    };
+    std::unordered_map<MkEnv*, FrameEnvironment> frameEnvironments;
+    // The heap stubs created while lowering a Deopt, null otherwise. All
+    // frames of a Deopt which refer to the same MkEnv have to get the same
+    // stub.
+    std::unordered_map<MkEnv*, llvm::Value*>* materializedFrameEnvs = nullptr;
+
+    // The llvm block holding the terminator of every BB lowered so far
+    std::unordered_map<BB*, llvm::BasicBlock*> blockEnd;
+    // Bounds guards per induction variable and vector, see
+    // inductionVariableInBounds
+    std::unordered_map<Value*, std::unordered_map<Value*, llvm::Value*>>
+        inductionVariableGuards;
+
     std::vector<ArglistOrder::CallArglistOrder> argReordering;
 
     std::unordered_map<Value*, std::unordered_map<SEXP, size_t>> bindingsCache;
@@ -89,8 +118,9 @@ class LowerFunctionLLVM {
         : target(target), cls(cls), code(code), promMap(promMap),
           refcount(refcount), needsLdVarForUpdate(needsLdVarForUpdate),
           builder(PirJitLLVM::getContext()), MDB(PirJitLLVM::getContext()),
-          liveness(code, code->nextBBId), numLocals(0), numTemps(0),
-          maxTemps(0), branchAlwaysTrue(MDB.createBranchWeights(100000000, 1)),
+          liveness(code, code->nextBBId), inductionVariables(code),
+          numLocals(0), numTemps(0), maxTemps(0),
+          branchAlwaysTrue(MDB.createBranchWeights(100000000, 1)),
           branchAlwaysFalse(MDB.createBranchWeights(1, 100000000)),
           branchMostlyTrue(MDB.createBranchWeights(1000, 1)),
           branchMostlyFalse(MDB.createBranchWeights(1, 1000)),
@@ -243,7 +273,8 @@ class LowerFunctionLLVM {
     void decStack(int i);
     llvm::Value* withCallFrame(const std::vector<Value*>& args,
                                const std::function<llvm::Value*()>& theCall,
-                               bool pop = true);
+                               bool pop = true,
+                               const Context* unboxedIn = nullptr);
     llvm::Value* load(Value* v, Rep r);
     llvm::Value* load(Value* v);
     llvm::Value* loadSxp(Value* v);
@@ -268,6 +299,13 @@ class LowerFunctionLLVM {
                     bool setNotMissing);
     void envStubSetNotMissing(llvm::Value* x, int i);
     void envStubSetMissing(llvm::Value* x, int i);
+    llvm::Value* envStubNames(MkEnv* env);
+
+    void computeFrameEnvironments();
+    bool inFrame(Value* env);
+    llvm::Value* frameEnvSlot(MkEnv* env, int i);
+    llvm::Value* frameEnvMissing(MkEnv* env, int i);
+    llvm::Value* materializeFrameEnv(MkEnv* env);
 
     void setVisible(int i);
 
@@ -322,6 +360,8 @@ class LowerFunctionLLVM {
     llvm::AllocaInst* topAlloca(llvm::Type* t, size_t len = 1);
 
     llvm::Value* argument(int i);
+    SEXPTYPE unboxedArgumentType(int i);
+    llvm::Value* unboxedArgument(int i, bool boxed);
     llvm::Value* convert(llvm::Value* val, PirType to, bool protect = true);
     void setVal(Instruction* i, llvm::Value* val);
 
@@ -411,9 +451,11 @@ class LowerFunctionLLVM {
 
     llvm::Value* force(Instruction* i, llvm::Value* arg);
 
+    llvm::Value* inductionVariableInBounds(Value* index, Value* vector);
     llvm::Value* computeAndCheckIndex(Value* index, llvm::Value* vector,
                                       llvm::BasicBlock* fallback,
-                                      llvm::Value* max = nullptr);
+                                      llvm::Value* max = nullptr,
+                                      Value* pirVector = nullptr);
     bool compileDotcall(Instruction* i,
                         const std::function<llvm::Value*()>& callee,
                         const std::function<SEXP(size_t)>& names);
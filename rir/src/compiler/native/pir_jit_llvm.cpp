@@ -5,6 +5,7 @@
 #include "compiler/native/pass_schedule_llvm.h"
 #include "compiler/native/types_llvm.h"
 #include "utils/filesystem.h"
+#include "utils/measuring.h"
 
 #include "llvm/ExecutionEngine/JITSymbol.h"
 #include "llvm/ExecutionEngine/Orc/Core.h"
@@ -26,6 +27,8 @@ namespace pir {
 std::unique_ptr<llvm::orc::LLJIT> PirJitLLVM::JIT;
 
 size_t PirJitLLVM::nModules = 1;
+size_t PirJitLLVM::nLiveModules = 0;
+size_t PirJitLLVM::nativeCodeBytes = 0;
 bool PirJitLLVM::initialized = false;
 
 bool LLVMDebugInfo() {
@@ -40,8 +43,48 @@ llvm::orc::ThreadSafeContext TSC;
 
 std::string dbgFolder;
 
+bool MEASURE_NATIVE_CODE = getenv("PIR_MEASURE_NATIVE_CODE") ? true : false;
+
 } // namespace
 
+// Accounts for the memory of the object files linked into the JIT. There is
+// one memory manager per module, it is destroyed when the module is removed.
+class NativeCodeMemoryManager : public llvm::SectionMemoryManager {
+    size_t allocated = 0;
+
+    void account(uintptr_t size) {
+        allocated += size;
+        PirJitLLVM::nativeCodeBytes += size;
+        if (MEASURE_NATIVE_CODE)
+            Measuring::setGauge("native code bytes",
+                                PirJitLLVM::nativeCodeBytes);
+    }
+
+  public:
+    uint8_t* allocateCodeSection(uintptr_t size, unsigned alignment,
+                                 unsigned sectionID,
+                                 llvm::StringRef sectionName) override {
+        account(size);
+        return SectionMemoryManager::allocateCodeSection(
+            size, alignment, sectionID, sectionName);
+    }
+
+    uint8_t* allocateDataSection(uintptr_t size, unsigned alignment,
+                                 unsigned sectionID,
+                                 llvm::StringRef sectionName,
+                                 bool isReadOnly) override {
+        account(size);
+        return SectionMemoryManager::allocateDataSection(
+            size, alignment, sectionID, sectionName, isReadOnly);
+    }
+
+    // Gauges are updated by releaseModule, this might also run during static
+    // destruction
+    ~NativeCodeMemoryManager() override {
+        PirJitLLVM::nativeCodeBytes -= allocated;
+    }
+};
+
 void PirJitLLVM::DebugInfo::addCode(Code* c) {
     assert(!codeLoc.count(c));
     codeLoc[c] = line++;
@@ -319,14 +362,50 @@ void PirJitLLVM::finalize() {
         // TODO: maybe later have TSM from the start and use locking
         //       to allow concurrent compilation?
         auto TSM = llvm::orc::ThreadSafeModule(std::move(M), TSC);
-        ExitOnErr(JIT->addIRModule(std::move(TSM)));
-        for (auto& fix : jitFixup)
+        auto tracker = JIT->getMainJITDylib().createResourceTracker();
+        ExitOnErr(JIT->addIRModule(tracker, std::move(TSM)));
+        // Each of these is only optimized and compiled to machine code once
+        // one of its symbols is looked up, i.e. the promise is first forced
+        for (auto& lazy : lazyModules)
+            ExitOnErr(JIT->addIRModule(
+                tracker, llvm::orc::ThreadSafeModule(std::move(lazy), TSC)));
+        lazyModules.clear();
+
+        // All Code objects of this module share the handle, the finalizer
+        // removes the module once none of them is reachable anymore
+        auto handle = R_MakeExternalPtr(
+            new llvm::orc::ResourceTrackerSP(tracker), R_NilValue, R_NilValue);
+        PROTECT(handle);
+        R_RegisterCFinalizerEx(handle, &PirJitLLVM::releaseModule, FALSE);
+        for (auto& fix : jitFixup) {
             fix.second.first->lazyCodeHandle(fix.second.second.str());
+            fix.second.first->nativeModule(handle);
+        }
+        UNPROTECT(1);
         nModules++;
+        nLiveModules++;
+        if (MEASURE_NATIVE_CODE)
+            Measuring::setGauge("native modules", nLiveModules);
     }
     finalized = true;
 }
 
+void PirJitLLVM::releaseModule(SEXP handle) {
+    auto tracker =
+        static_cast<llvm::orc::ResourceTrackerSP*>(R_ExternalPtrAddr(handle));
+    if (!tracker)
+        return;
+    R_ClearExternalPtr(handle);
+    ExitOnErr((*tracker)->remove());
+    delete tracker;
+    nLiveModules--;
+    if (MEASURE_NATIVE_CODE) {
+        Measuring::setGauge("native modules", nLiveModules);
+        Measuring::setGauge("native code bytes", nativeCodeBytes);
+        Measuring::countEvent("native modules freed");
+    }
+}
+
 void PirJitLLVM::compile(
     rir::Code* target, ClosureVersion* closure, Code* code,
     const PromMap& promMap, const NeedsRefcountAdjustment& refcount,
@@ -369,6 +448,16 @@ void PirJitLLVM::compile(
         DI->addCode(code);
     }
 
+    // Promises go into a module of their own, such that their machine code
+    // is only generated when they are actually forced. With debug info
+    // everything stays in M, since the DIBuilder is tied to it.
+    llvm::Module* mod = M.get();
+    if (code != closure && !LLVMDebugInfo()) {
+        lazyModules.emplace_back(
+            std::make_unique<llvm::Module>("", *TSC.getContext()));
+        mod = lazyModules.back().get();
+    }
+
     std::string mangledName = JIT->mangle(makeName(code));
 
     LowerFunctionLLVM funCompiler(
@@ -378,7 +467,7 @@ void PirJitLLVM::compile(
         [&](Code* c, const std::string& name, llvm::FunctionType* signature) {
             assert(!funs.count(c));
             auto f = llvm::Function::Create(
-                signature, llvm::Function::ExternalLinkage, name, *M);
+                signature, llvm::Function::ExternalLinkage, name, *mod);
             if (LLVMDebugInfo()) {
                 llvm::AttrBuilder ab;
                 ab.addAttribute(llvm::Attribute::get(*TSC.getContext(),
@@ -395,7 +484,7 @@ void PirJitLLVM::compile(
             return f;
         },
         // getModule
-        [&]() -> llvm::Module& { return *M; },
+        [&]() -> llvm::Module& { return *mod; },
         // getFunction
         [&](Code* c) -> llvm::Function* {
             auto r = funs.find(c);
@@ -450,7 +539,7 @@ void PirJitLLVM::compile(
             // For debugging, print the whole module to see the debuginfo
             // Also comment out insn_assert in lower_function_llvm.cpp to get
             // smaller listings...
-            ro << *M;
+            ro << *mod;
         } else {
             funCompiler.fun->print(ro, nullptr);
         }
@@ -486,7 +575,7 @@ void PirJitLLVM::initializeLLVM() {
             .setObjectLinkingLayerCreator(
                 [&](ExecutionSession& ES, const Triple& TT) {
                     auto GetMemMgr = []() {
-                        return std::make_unique<SectionMemoryManager>();
+                        return std::make_unique<NativeCodeMemoryManager>();
                     };
                     auto ObjLinkingLayer =
                         std::make_unique<RTDyldObjectLinkingLayer>(
@@ -22,6 +22,7 @@
 #include <sstream>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 namespace rir {
 
@@ -62,11 +63,19 @@ class PirJitLLVM {
 
     static llvm::LLVMContext& getContext();
 
+    // Each module is added to the JIT with its own ResourceTracker. It is
+    // removed again, freeing its native code, when the last rir::Code compiled
+    // into it is garbage collected (see Code::nativeModule).
+    static size_t liveModules() { return nLiveModules; }
+    static size_t liveNativeCodeBytes() { return nativeCodeBytes; }
+
   private:
     std::string name;
 
     // Initialized on the first call to compile
     std::unique_ptr<llvm::Module> M;
+    // Promise bodies, compiled lazily on first use
+    std::vector<std::unique_ptr<llvm::Module>> lazyModules;
 
     // Directory of all functions and builtins
     std::unordered_map<Code*, llvm::Function*> funs;
@@ -86,6 +95,10 @@ class PirJitLLVM {
     bool finalized = false;
 
     static size_t nModules;
+    static size_t nLiveModules;
+    static size_t nativeCodeBytes;
+    static void releaseModule(SEXP handle);
+    friend class NativeCodeMemoryManager;
     static void initializeLLVM();
     static bool initialized;
 
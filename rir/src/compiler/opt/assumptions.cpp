@@ -3,6 +3,7 @@
 #include "../pir/pir_impl.h"
 #include "../util/visitor.h"
 #include "compiler/analysis/cfg.h"
+#include "compiler/compiler.h"
 
 #include "R/r.h"
 #include "pass_definitions.h"
@@ -185,8 +186,8 @@ struct AvailableAssumptions
     }
 };
 
-bool OptimizeAssumptions::apply(Compiler&, ClosureVersion* vers, Code* code,
-                                AbstractLog& log, size_t) const {
+bool OptimizeAssumptions::apply(Compiler& cmp, ClosureVersion* vers,
+                                Code* code, AbstractLog& log, size_t) const {
     {
         Visitor::run(code->entry, [&](BB* bb) {
             if (bb->isBranch()) {
@@ -205,7 +206,7 @@ bool OptimizeAssumptions::apply(Compiler&, ClosureVersion* vers, Code* code,
 
     AvailableCheckpoints checkpoint(vers, code, log);
     AvailableAssumptions assumptions(vers, code, log);
-    DominanceGraph dom(code);
+    auto& dom = cmp.analyses.dominance(code);
     std::unordered_map<Checkpoint*, Checkpoint*> replaced;
 
     std::unordered_map<Instruction*,
@@ -2,6 +2,8 @@
 #include "../pir/pir_impl.h"
 #include "../util/visitor.h"
 #include "compiler/analysis/cfg.h"
+#include "compiler/parameter.h"
+#include "utils/measuring.h"
 
 #include "R/r.h"
 #include "pass_definitions.h"
@@ -51,6 +53,8 @@ bool OptimizeContexts::apply(Compiler&, ClosureVersion* cls, Code* code,
         return anyChange;
 
     assert(toRemove.size() % 2 == 0);
+    if (Parameter::MEASURE_CONTEXTS)
+        Measuring::countEvent("contexts elided", toRemove.size() / 2);
 
     Visitor::run(code->entry, [&](BB* bb) {
         auto ip = bb->begin();
@@ -74,5 +78,8 @@ bool OptimizeContexts::apply(Compiler&, ClosureVersion* cls, Code* code,
     return true;
 }
 
+bool Parameter::MEASURE_CONTEXTS =
+    getenv("PIR_MEASURE_CONTEXTS") ? true : false;
+
 } // namespace pir
 } // namespace rir
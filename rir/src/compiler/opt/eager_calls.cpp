@@ -207,6 +207,9 @@ bool EagerCalls::apply(Compiler& cmp, ClosureVersion* cls, Code* code,
                                                 ip = replaceCallWithCallBuiltin(
                                                     bb, ip, call, builtin,
                                                     !inBase);
+                                                if (inBase)
+                                                    cls->speculatedBindings
+                                                        .insert(name);
                                             }
                                             if (!inBase &&
                                                 ldfun->typeFeedback()
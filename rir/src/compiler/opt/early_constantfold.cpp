@@ -59,7 +59,7 @@ bool EarlyConstantfold::apply(Compiler& cmp, ClosureVersion* cls, Code* code,
                               AbstractLog& log, size_t) const {
     bool anyChange = false;
     AvailableCheckpoints checkpoint(cls, code, log);
-    DominanceGraph dom(code);
+    auto& dom = cmp.analyses.dominance(code);
 
     Visitor::run(code->entry, [&](BB* bb) {
         if (bb->isEmpty())
@@ -2,6 +2,7 @@
 #include "compiler/analysis/available_checkpoints.h"
 #include "compiler/analysis/cfg.h"
 #include "compiler/analysis/context_stack.h"
+#include "compiler/compiler.h"
 #include "compiler/pir/pir_impl.h"
 #include "compiler/util/bb_transform.h"
 #include "compiler/util/env_stub_info.h"
@@ -16,13 +17,13 @@
 namespace rir {
 namespace pir {
 
-bool ElideEnvSpec::apply(Compiler&, ClosureVersion* cls, Code* code,
+bool ElideEnvSpec::apply(Compiler& cmp, ClosureVersion* cls, Code* code,
                          AbstractLog& log, size_t iteration) const {
 
     constexpr bool debug = false;
     AvailableCheckpoints checkpoint(cls, code, log);
     ContextStack cs(cls, code, log);
-    DominanceGraph dom(code);
+    auto& dom = cmp.analyses.dominance(code);
 
     auto envOnlyForObj = [&](Instruction* i) {
         if (i->envOnlyForObj())
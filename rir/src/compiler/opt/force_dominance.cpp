@@ -2,6 +2,7 @@
 #include "../analysis/available_checkpoints.h"
 #include "../parameter.h"
 #include "../pir/pir_impl.h"
+#include "compiler/compiler.h"
 #include "compiler/util/bb_transform.h"
 #include "compiler/util/safe_builtins_list.h"
 #include "pass_definitions.h"
@@ -39,7 +40,7 @@ namespace pir {
  *
  */
 
-bool ForceDominance::apply(Compiler&, ClosureVersion* cls, Code* code,
+bool ForceDominance::apply(Compiler& cmp, ClosureVersion* cls, Code* code,
                            AbstractLog& log, size_t) const {
     bool anyChange = false;
 
@@ -406,7 +407,7 @@ bool ForceDominance::apply(Compiler&, ClosureVersion* cls, Code* code,
         }
     });
 
-    DominanceGraph dom(code);
+    auto& dom = cmp.analyses.dominance(code);
 
     // 2. replace dominated promises
     Visitor::run(code->entry, [&](BB* bb) {
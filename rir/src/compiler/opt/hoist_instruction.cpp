@@ -5,6 +5,7 @@
 #include "R/r.h"
 #include "compiler/analysis/cfg.h"
 #include "compiler/analysis/context_stack.h"
+#include "compiler/compiler.h"
 #include "pass_definitions.h"
 
 #include <unordered_set>
@@ -15,7 +16,7 @@ namespace pir {
 bool HoistInstruction::apply(Compiler& cmp, ClosureVersion* cls, Code* code,
                              AbstractLog& log, size_t) const {
     bool anyChange = false;
-    DominanceGraph dom(code);
+    auto& dom = cmp.analyses.dominance(code);
     ContextStack cs(cls, code, log);
 
     VisitorNoDeoptBranch::run(code->entry, [&](BB* bb) {
@@ -0,0 +1,241 @@
+#include "../analysis/loop_detection.h"
+#include "../pir/pir_impl.h"
+#include "../util/visitor.h"
+#include "compiler/parameter.h"
+#include "pass_definitions.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace rir {
+namespace pir {
+
+/*
+ * Loop versioning: if an innermost loop contains assumptions whose condition
+ * does not depend on the loop, we test them once before the loop and branch
+ * into one of two copies of it:
+ *
+ *   preheader:                          preheader:
+ *     ...                                 ...
+ *   header:                 ===>          Branch(cond) -> fast / generic
+ *     ...                               fast:    copy of the loop, with
+ *     Assume(cond, cp)                           Assume(cond) removed
+ *     ...                               generic: the original loop
+ *
+ * Failing the test is not a deopt, the generic copy still checks (and deopts
+ * on) the assumption when it is actually reached. Both copies leave through
+ * the same exit, where values defined in the loop are merged with Phis.
+ */
+
+// The condition can be evaluated in the preheader instead
+static bool isHoistableCondition(Instruction* cond,
+                                 const LoopDetection::Loop& loop) {
+    if (!IsType::Cast(cond) && !Identical::Cast(cond))
+        return false;
+    if (cond->hasEnv() || !cond->effects.empty())
+        return false;
+    return cond->allNonEnvArgs([&](Value* arg) {
+        auto i = Instruction::Cast(arg);
+        return !i || !loop.contains(i->bb());
+    });
+}
+
+static size_t loopSize(const LoopDetection::Loop& loop) {
+    size_t size = 0;
+    for (auto bb : loop)
+        size += bb->size();
+    return size;
+}
+
+bool LoopVersioning::apply(Compiler&, ClosureVersion*, Code* code,
+                           AbstractLog&, size_t) const {
+    LoopDetection loops(code, true);
+    bool anyChange = false;
+
+    for (auto& loop : loops) {
+        if (!loop.isInnermost() ||
+            loopSize(loop) > Parameter::LOOP_VERSIONING_MAX_SIZE)
+            continue;
+
+        auto header = loop.header();
+        auto preheader = loop.preheader();
+        if (!preheader || !preheader->isJmp())
+            continue;
+
+        // The region to copy is the loop and its deopt branches. Besides
+        // those, there must be a single exit.
+        std::unordered_set<BB*> region(loop.begin(), loop.end());
+        BB* exiting = nullptr;
+        BB* exit = nullptr;
+        bool ok = true;
+        for (auto bb : loop) {
+            for (auto suc : bb->successors()) {
+                if (loop.contains(suc))
+                    continue;
+                if (suc->isDeopt() && suc->predecessors().size() == 1) {
+                    region.insert(suc);
+                } else if (!exit && bb->isBranch() &&
+                           suc->predecessors().size() == 1) {
+                    exiting = bb;
+                    exit = suc;
+                } else {
+                    ok = false;
+                }
+            }
+        }
+        if (!ok || !exit)
+            continue;
+
+        auto inRegion = [&](Instruction* i) { return region.count(i->bb()); };
+
+        // Assumptions which can be tested before the loop
+        std::vector<Assume*> hoist;
+        std::vector<std::pair<Instruction*, bool>> guards;
+        for (auto bb : loop) {
+            for (auto i : *bb) {
+                auto assume = Assume::Cast(i);
+                if (!assume)
+                    continue;
+                auto cond = Instruction::Cast(assume->condition());
+                if (!cond ||
+                    (inRegion(cond) && !isHoistableCondition(cond, loop)))
+                    continue;
+                hoist.push_back(assume);
+                auto g = std::make_pair(cond, assume->assumeTrue);
+                if (std::find(guards.begin(), guards.end(), g) == guards.end())
+                    guards.push_back(g);
+            }
+        }
+        if (hoist.empty())
+            continue;
+
+        // Values defined in the loop and used after it need a Phi at the
+        // exit. Environments and promises cannot be merged like that.
+        std::vector<Instruction*> liveOut;
+        Visitor::run(code->entry, [&](Instruction* i) {
+            if (inRegion(i))
+                return;
+            i->eachArg([&](Value* arg) {
+                auto a = Instruction::Cast(arg);
+                if (a && inRegion(a) &&
+                    std::find(liveOut.begin(), liveOut.end(), a) ==
+                        liveOut.end()) {
+                    if (!a->type.isRType() || MkEnv::Cast(a) || MkArg::Cast(a))
+                        ok = false;
+                    liveOut.push_back(a);
+                }
+            });
+        });
+        if (!ok)
+            continue;
+
+        // Copy the region
+        std::unordered_map<BB*, BB*> bbs;
+        std::unordered_set<BB*> copies;
+        std::unordered_map<Value*, Instruction*> relocation;
+        for (auto bb : region) {
+            auto copy = BB::cloneInstrs(bb, code->nextBBId++, code);
+            bbs[bb] = copy;
+            copies.insert(copy);
+            for (size_t i = 0; i < bb->size(); ++i)
+                relocation[bb->at(i)] = copy->at(i);
+        }
+        auto relocate = [&](Value* v) -> Value* {
+            auto r = relocation.find(v);
+            return r == relocation.end() ? v : r->second;
+        };
+
+        // Both copies leave through their own split block into the exit
+        auto exitSplit = new BB(code, code->nextBBId++);
+        auto exitSplitCopy = new BB(code, code->nextBBId++);
+        exiting->replaceSuccessor(exit, exitSplit);
+        exitSplit->setNext(exit);
+        exitSplitCopy->setNext(exit);
+
+        for (auto bb : region) {
+            bbs.at(bb)->setSuccessors(bb->successors().map([&](BB* suc) {
+                if (suc == exitSplit)
+                    return exitSplitCopy;
+                return bbs.at(suc);
+            }));
+        }
+
+        // Test the assumptions in the preheader. The fast copy is entered
+        // through `fastEntry`, the original loop through `genericEntry`.
+        auto genericEntry = new BB(code, code->nextBBId++);
+        genericEntry->setNext(header);
+        preheader->deleteSuccessors();
+        auto pos = preheader;
+        for (auto g : guards) {
+            auto cond = g.first;
+            if (inRegion(cond)) {
+                cond = cond->clone();
+                pos->append(cond);
+            }
+            pos->append(new Branch(cond));
+            auto next = new BB(code, code->nextBBId++);
+            auto fail = new BB(code, code->nextBBId++);
+            fail->setNext(genericEntry);
+            if (g.second)
+                pos->setBranch(next, fail);
+            else
+                pos->setBranch(fail, next);
+            pos = next;
+        }
+        auto fastEntry = pos;
+        fastEntry->setNext(bbs.at(header));
+
+        for (auto bb : region) {
+            for (auto i : *bbs.at(bb)) {
+                if (auto phi = Phi::Cast(i)) {
+                    for (size_t j = 0; j < phi->nargs(); ++j) {
+                        auto in = phi->inputAt(j);
+                        phi->updateInputAt(j, in == preheader ? fastEntry
+                                                              : bbs.at(in));
+                    }
+                }
+                i->eachArg(
+                    [&](InstrArg& arg) { arg.val() = relocate(arg.val()); });
+            }
+        }
+        for (auto i : *header) {
+            if (auto phi = Phi::Cast(i)) {
+                for (size_t j = 0; j < phi->nargs(); ++j)
+                    if (phi->inputAt(j) == preheader)
+                        phi->updateInputAt(j, genericEntry);
+            }
+        }
+
+        // Merge the values used after the loop
+        for (auto v : liveOut) {
+            auto phi = new Phi(v->type);
+            phi->addInput(exitSplit, v);
+            phi->addInput(exitSplitCopy, relocate(v));
+            exit->insert(exit->begin(), phi);
+            v->replaceUsesWith(phi, [](Instruction*, size_t) {},
+                               [&](Instruction* user) {
+                                   return user != phi && !inRegion(user) &&
+                                          !copies.count(user->bb());
+                               });
+        }
+
+        // The fast copy does not need to check the hoisted assumptions
+        for (auto assume : hoist) {
+            auto copy = relocation.at(assume);
+            copy->bb()->remove(copy);
+        }
+
+        anyChange = true;
+    }
+
+    return anyChange;
+}
+
+size_t Parameter::LOOP_VERSIONING_MAX_SIZE =
+    getenv("PIR_LOOP_VERSIONING_MAX_SIZE")
+        ? atoi(getenv("PIR_LOOP_VERSIONING_MAX_SIZE"))
+        : 200;
+
+} // namespace pir
+} // namespace rir
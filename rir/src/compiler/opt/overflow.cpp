@@ -1,4 +1,5 @@
 #include "compiler/analysis/cfg.h"
+#include "compiler/analysis/induction_variables.h"
 #include "compiler/pir/pir_impl.h"
 #include "compiler/util/visitor.h"
 #include "pass_definitions.h"
@@ -10,6 +11,7 @@ namespace pir {
 bool Overflow::apply(Compiler&, ClosureVersion* cls, Code* code, AbstractLog&,
                      size_t) const {
     UsesTree uses(code);
+    InductionVariables ivs(code);
 
     auto willDefinitelyNotOverflow = [&](Instruction* instr) {
         assert(Add::Cast(instr) || Sub::Cast(instr));
@@ -81,6 +83,14 @@ bool Overflow::apply(Compiler&, ClosureVersion* cls, Code* code, AbstractLog&,
         // is on non-NA typed integers
         if (!instr->type.maybeNAOrNaN())
             return;
+        // the increment of a well formed induction variable stays between
+        // init and end, which are both integers
+        if (auto iv = ivs.incrementOf(instr)) {
+            if (iv->wellFormed) {
+                instr->type = instr->type.notNAOrNaN();
+                return;
+            }
+        }
         // didn't already infer that it's non-NA
         if (!willDefinitelyNotOverflow(instr))
             return;
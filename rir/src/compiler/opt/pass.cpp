@@ -1,4 +1,5 @@
 #include "pass.h"
+#include "compiler/compiler.h"
 #include "compiler/pir/closure_version.h"
 #include "compiler/pir/promise.h"
 
@@ -7,6 +8,7 @@ namespace pir {
 
 bool Pass::apply(Compiler& cmp, ClosureVersion* function, AbstractLog& log,
                  size_t iteration) const {
+    cmp.analyses.beginPass();
     bool res = apply(cmp, function, function, log, iteration);
     if (runOnPromises()) {
         function->eachPromise([&](Promise* p) {
@@ -14,6 +16,8 @@ bool Pass::apply(Compiler& cmp, ClosureVersion* function, AbstractLog& log,
         });
     }
     changedAnything_ = res;
+    if (res)
+        cmp.analyses.invalidate(function);
     return res;
 }
 
@@ -162,6 +162,18 @@ PASS(Overflow, true, false)
  */
 PASS(HoistInstruction, false, false)
 
+/*
+ * Tests loop invariant assumptions of innermost loops once before the loop and
+ * branches to a copy of the loop without them.
+ */
+PASS(LoopVersioning, false, false)
+
+/*
+ * Turns self-recursive calls in tail position into loops, if the version does
+ * not observe its context.
+ */
+PASS(TailRecursion, false, false)
+
 PASS(TypefeedbackCleanup, true, false)
 
 class PhaseMarker : public Pass {
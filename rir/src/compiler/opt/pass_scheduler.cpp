@@ -101,6 +101,9 @@ PassScheduler::PassScheduler(unsigned optLevel, bool isFinal) {
     if (optLevel > 1) {
         nextPhase("Speculation post");
         addDefaultPostPhaseOpt();
+        add<TailRecursion>();
+        // Runs once, otherwise it would keep copying the generic version
+        add<LoopVersioning>();
 
         // ==== Phase 3) Remove checkpoints we did not use
         //
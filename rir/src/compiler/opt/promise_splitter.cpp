@@ -1,6 +1,7 @@
 #include "../pir/pir_impl.h"
 #include "../util/visitor.h"
 #include "compiler/analysis/cfg.h"
+#include "compiler/compiler.h"
 #include "pass_definitions.h"
 #include "utils/Map.h"
 #include "utils/Set.h"
@@ -8,7 +9,7 @@
 namespace rir {
 namespace pir {
 
-bool PromiseSplitter::apply(Compiler&, ClosureVersion* cls, Code* code,
+bool PromiseSplitter::apply(Compiler& cmp, ClosureVersion* cls, Code* code,
                             AbstractLog&, size_t) const {
 
     bool anyChange = false;
@@ -48,7 +49,7 @@ bool PromiseSplitter::apply(Compiler&, ClosureVersion* cls, Code* code,
                 banned.insert(p);
     });
 
-    CFG cfg(code);
+    auto& cfg = cmp.analyses.cfg(code);
     SmallSet<CastType*> toSplit;
     for (const auto& c : candidates) {
         const auto& us = uses.find(c);
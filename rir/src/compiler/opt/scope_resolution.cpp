@@ -97,13 +97,12 @@ namespace pir {
 bool ScopeResolution::apply(Compiler& cmp, ClosureVersion* cls, Code* code,
                             AbstractLog& log, size_t) const {
 
-    DominanceGraph dom(code);
-    DominanceFrontier dfront(code, dom);
+    auto& dom = cmp.analyses.dominance(code);
+    auto& dfront = cmp.analyses.dominanceFrontier(code);
     ContextStack contexts(cls, code, log);
 
     bool anyChange = false;
-    ScopeAnalysis analysis(cls, code, log);
-    analysis();
+    auto& analysis = cmp.analyses.scope(cls, code, log);
     auto& finalState = analysis.result();
     if (finalState.noReflection() && code == cls)
         cls->properties.set(ClosureVersion::Property::NoReflection);
@@ -689,6 +688,8 @@ bool ScopeResolution::apply(Compiler& cmp, ClosureVersion* cls, Code* code,
                                             TYPEOF(value) == CLOSXP) {
                                             i->replaceUsesWith(
                                                 cmp.module->c(value));
+                                            cls->speculatedBindings.insert(
+                                                name);
                                             next = bb->remove(ip);
                                             changed = true;
                                             return;
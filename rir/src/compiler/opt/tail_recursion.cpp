@@ -0,0 +1,143 @@
+#include "../pir/pir_impl.h"
+#include "../util/visitor.h"
+#include "pass_definitions.h"
+
+#include <unordered_map>
+
+namespace rir {
+namespace pir {
+
+/*
+ * Turns calls of a version to itself, whose result is immediately returned,
+ * into a jump back to the start of the version:
+ *
+ *   BB0:                                 BB0:
+ *     x = LdArg(0)                         x0 = LdArg(0)
+ *   BB1:                                 BB1:
+ *     ...                    ===>          x = Phi(BB0:x0, BB3:y)
+ *   BB2:                                   ...
+ *     r = StaticCall(f, y)               BB2:
+ *     Return r                             goto BB3 -> BB1
+ *
+ * The iterations share the context of the first call. This is only done if
+ * nothing in the version can observe contexts or the promises of arguments,
+ * and if all arguments are passed eagerly.
+ */
+
+static bool isSelfCall(Instruction* i, ClosureVersion* cls) {
+    auto call = StaticCall::Cast(i);
+    return call && call->tryDispatch() == cls;
+}
+
+static bool observesFrames(ClosureVersion* cls) {
+    bool observes = false;
+    auto check = [&](Instruction* i) {
+        if (LdFunctionEnv::Cast(i) || NonLocalReturn::Cast(i))
+            observes = true;
+        else if (!isSelfCall(i, cls) &&
+                 (i->mayUseReflection() ||
+                  i->effects.contains(Effect::ExecuteCode)))
+            observes = true;
+    };
+    Visitor::run(cls->entry, check);
+    cls->eachPromise([&](Promise* p) { Visitor::run(p->entry, check); });
+    return observes;
+}
+
+bool TailRecursion::apply(Compiler&, ClosureVersion* cls, Code* code,
+                          AbstractLog&, size_t) const {
+    if (code != cls || cls->isContinuation())
+        return false;
+
+    std::unordered_map<size_t, LdArg*> ldArgs;
+    bool ok = true;
+    Visitor::run(code->entry, [&](Instruction* i) {
+        if (auto ld = LdArg::Cast(i)) {
+            if (ldArgs.count(ld->pos))
+                ok = false;
+            ldArgs[ld->pos] = ld;
+        }
+    });
+    if (!ok)
+        return false;
+
+    struct TailCall {
+        BB* bb;
+        StaticCall* call;
+        std::vector<Value*> args;
+    };
+    std::vector<TailCall> tailCalls;
+    Visitor::run(code->entry, [&](BB* bb) {
+        if (!bb->isExit() || bb->isEmpty())
+            return;
+        auto ret = Return::Cast(bb->last());
+        if (!ret)
+            return;
+        auto call = StaticCall::Cast(ret->arg(0).val());
+        if (!call || call->bb() != bb || !isSelfCall(call, cls) ||
+            call->hasSingleUse() != ret ||
+            call->nCallArgs() != cls->effectiveNArgs())
+            return;
+        for (auto it = bb->atPosition(call) + 1; *it != ret; ++it)
+            if ((*it)->hasEffect())
+                return;
+
+        TailCall tail = {bb, call, {}};
+        bool eager = true;
+        call->eachCallArg([&](Value* arg) {
+            if (auto mk = MkArg::Cast(arg)) {
+                if (!mk->isEager())
+                    eager = false;
+                arg = mk->eagerArg();
+            }
+            auto ld = ldArgs.find(tail.args.size());
+            if (arg->type.maybeLazy() || arg->type.maybePromiseWrapped() ||
+                (ld != ldArgs.end() && !arg->type.isA(ld->second->type)))
+                eager = false;
+            tail.args.push_back(arg);
+        });
+        if (eager)
+            tailCalls.push_back(tail);
+    });
+    if (tailCalls.empty() || observesFrames(cls))
+        return false;
+
+    // The arguments are loaded in a new entry block, the old one becomes the
+    // loop header
+    auto header = code->entry;
+    auto start = new BB(code, code->nextBBId++);
+    code->entry = start;
+    start->setNext(header);
+
+    std::unordered_map<size_t, Phi*> phis;
+    for (auto& a : ldArgs) {
+        auto ld = a.second;
+        ld->bb()->moveToEnd(ld->bb()->atPosition(ld), start);
+        auto phi = new Phi(ld->type);
+        phi->addInput(start, ld);
+        header->insert(header->begin(), phi);
+        ld->replaceUsesWith(phi, [](Instruction*, size_t) {},
+                            [&](Instruction* user) { return user != phi; });
+        phis[a.first] = phi;
+    }
+
+    for (auto& tail : tailCalls) {
+        auto ret = tail.bb->last();
+        tail.bb->remove(ret);
+        tail.bb->remove(tail.call);
+        auto latch = new BB(code, code->nextBBId++);
+        tail.bb->setNext(latch);
+        latch->setNext(header);
+        for (auto& p : phis) {
+            auto arg = tail.args.at(p.first);
+            if (auto ld = LdArg::Cast(arg))
+                arg = phis.at(ld->pos);
+            p.second->addInput(latch, arg);
+        }
+    }
+
+    return true;
+}
+
+} // namespace pir
+} // namespace rir
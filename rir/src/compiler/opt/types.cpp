@@ -80,6 +80,7 @@ bool TypeInference::apply(Compiler&, ClosureVersion* cls, Code* code,
         }
     }
 
+    bool changed = false;
     Visitor::run(code->entry, [&](Instruction* i) {
         if (!i->type.isRType())
             return;
@@ -90,12 +91,14 @@ bool TypeInference::apply(Compiler&, ClosureVersion* cls, Code* code,
             // void, since it will always error. However we do not want this to
             // happen as it is guaranteed to cause problems downstream, e.g. in
             // code generation.
-            if (!t->second.isVoid())
+            if (!t->second.isVoid() && i->type != t->second) {
                 i->type = t->second;
+                changed = true;
+            }
         }
     });
 
-    return false;
+    return changed;
 }
 
 } // namespace pir
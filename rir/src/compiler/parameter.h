@@ -27,6 +27,8 @@ struct Parameter {
 
     static size_t RECOMPILE_THRESHOLD;
 
+    static size_t LOOP_VERSIONING_MAX_SIZE;
+
     static bool RIR_PRESERVE;
     static unsigned RIR_SERIALIZE_CHAOS;
 
@@ -38,6 +40,8 @@ struct Parameter {
     static bool ENABLE_PIR2RIR;
 
     static bool ENABLE_OSR;
+
+    static bool MEASURE_CONTEXTS;
 };
 
 } // namespace pir
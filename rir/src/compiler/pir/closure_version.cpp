@@ -91,6 +91,7 @@ ClosureVersion* ClosureVersion::clone(const Context& newAssumptions) {
     auto ctx = optimizationContext_ | newAssumptions;
     auto c = owner_->declareVersion(ctx, false, optFunction);
     c->properties = properties;
+    c->speculatedBindings = speculatedBindings;
     c->entry = BBTransform::clone(entry, c, c);
     return c;
 }
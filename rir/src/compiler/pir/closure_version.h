@@ -8,6 +8,7 @@
 #include <functional>
 #include <sstream>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace rir {
 namespace pir {
@@ -65,6 +66,10 @@ class ClosureVersion : public Code {
 
     Properties properties;
 
+    // Locked base bindings which were folded into constants, the compiled
+    // Function is registered with SpeculatedBindings
+    std::unordered_set<SEXP> speculatedBindings;
+
     Closure* owner() const { return owner_; }
     size_t nargs() const;
     size_t effectiveNArgs() const;
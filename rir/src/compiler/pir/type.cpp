@@ -254,6 +254,14 @@ void PirType::fromContext(const Context& assumptions, unsigned arg,
             type = type & PirType::simpleScalarReal().orPromiseWrapped();
         if (assumptions.isSimpleInt(i))
             type = type & PirType::simpleScalarInt().orPromiseWrapped();
+        if (assumptions.isPlainNumVec(i)) {
+            auto plainNumVec = PirType::intReal().orPromiseWrapped();
+            if (assumptions.isNAFree(i))
+                plainNumVec = plainNumVec.notNAOrNaN();
+            type = type & plainNumVec;
+        }
+        if (assumptions.isPlainList(i))
+            type = type & PirType(RType::vec).orPromiseWrapped();
     }
     // well, if the intersection of context info and current type is void, we
     // probably made a wrong speculation. it's most probably a bug somewhere,
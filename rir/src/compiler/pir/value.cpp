@@ -14,6 +14,17 @@ void Value::callArgTypeToContext(Context& assumptions, unsigned i) const {
     auto arg = this;
     assert(!arg->type.maybePromiseWrapped());
 
+    // Args beyond the individually typed ones only contribute to the summary
+    if (i >= Context::NUM_TYPED_ARGS) {
+        Context rest;
+        rest.add(Assumption::NoExplicitlyMissingArgs);
+        callArgTypeToContext(rest, 0);
+        if (!rest.includes(Assumption::NoExplicitlyMissingArgs))
+            assumptions.remove(Assumption::NoExplicitlyMissingArgs);
+        assumptions.addRestArg(i, rest);
+        return;
+    }
+
     if (auto mk = MkArg::Cast(arg)) {
         if (mk->isEager() || mk->noReflection)
             assumptions.setNonRefl(i);
@@ -47,6 +58,14 @@ void Value::callArgTypeToContext(Context& assumptions, unsigned i) const {
                 if (arg->type.isRType(RType::integer))
                     assumptions.setSimpleInt(i);
             }
+            auto plainNumVec = PirType::intReal().orPromiseWrapped();
+            if (arg->type.isA(plainNumVec)) {
+                assumptions.setPlainNumVec(i);
+                if (arg->type.isA(plainNumVec.notNAOrNaN()))
+                    assumptions.setNAFree(i);
+            }
+            if (arg->type.isA(PirType(RType::vec).orPromiseWrapped()))
+                assumptions.setPlainList(i);
         }
     };
     check(arg);
@@ -43,7 +43,7 @@ struct Matcher {
 
     bool operator()(Opcode* pc, const Opcode* end, MatcherMaybe m) const {
         for (size_t i = 0; i < SIZE; ++i) {
-            if (*pc != seq[i])
+            if (BC::dequicken(*pc) != seq[i])
                 return false;
             pc = BC::next(pc);
             if (pc == end)
@@ -423,6 +423,15 @@ bool testCfg() {
         assert(!cfg.isPredecessor(&B, &C));
         assert(!cfg.isPredecessor(&D, &C));
 
+        ReversePostOrder rpo(&MockBB::code);
+
+        assert(rpo.size() == 5);
+        assert(rpo.at(0) == &A);
+        assert(rpo.at(4) == &F);
+        assert(rpo.position(&B) < rpo.position(&F));
+        assert(rpo.position(&C) < rpo.position(&D));
+        assert(!rpo.reached(&E));
+
         DominanceGraph dom(&MockBB::code);
 
         assert(dom.dominates(&A, &A));
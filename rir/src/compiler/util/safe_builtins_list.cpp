@@ -313,8 +313,14 @@ bool SafeBuiltinsList::nonObject(int builtin) {
     case blt("colSums"):
 
     case blt("paste"):
+    case blt("paste0"):
     case blt("nchar"):
     case blt("pmatch"):
+    case blt("substr"):
+    case blt("startsWith"):
+    case blt("endsWith"):
+    case blt("toupper"):
+    case blt("tolower"):
 
     case blt("seq.int"):
     case blt("rep.int"):
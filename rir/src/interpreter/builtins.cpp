@@ -6,7 +6,10 @@
 #include "runtime/LazyArglist.h"
 
 #include <algorithm>
+#include <cctype>
+#include <cstring>
 #include <stdlib.h>
+#include <string>
 
 extern "C" {
 extern Rboolean R_Visible;
@@ -125,6 +128,234 @@ static IsVectorCheck whichIsVectorCheck(SEXP str) {
     return IsVectorCheck::unsupported;
 }
 
+// The string fast paths only handle plain character vectors of ASCII strings.
+// For those, chars, bytes and widths coincide and no translation between
+// encodings is needed.
+static bool isAscii(SEXP c) {
+    if (c == NA_STRING)
+        return true;
+    for (auto p = CHAR(c); *p; ++p)
+        if ((unsigned char)*p > 127)
+            return false;
+    return true;
+}
+
+static bool isPlainAsciiStrings(SEXP x) {
+    if (TYPEOF(x) != STRSXP || ATTRIB(x) != R_NilValue)
+        return false;
+    for (R_xlen_t i = 0; i < XLENGTH(x); ++i)
+        if (!isAscii(STRING_ELT(x, i)))
+            return false;
+    return true;
+}
+
+static bool isScalarString(SEXP x, const char* value) {
+    return TYPEOF(x) == STRSXP && XLENGTH(x) == 1 &&
+           STRING_ELT(x, 0) != NA_STRING &&
+           strcmp(CHAR(STRING_ELT(x, 0)), value) == 0;
+}
+
+template <typename T>
+static bool appendFormatted(std::string& out, const std::string& spec,
+                            T value) {
+    auto n = snprintf(nullptr, 0, spec.c_str(), value);
+    if (n < 0)
+        return false;
+    auto pos = out.size();
+    out.resize(pos + n + 1);
+    snprintf(&out[pos], n + 1, spec.c_str(), value);
+    out.resize(pos + n);
+    return true;
+}
+
+static SEXP stringPaste0(SEXP list, SEXP collapse) {
+    if (TYPEOF(list) != VECSXP || XLENGTH(list) == 0 ||
+        collapse != R_NilValue)
+        return nullptr;
+    R_xlen_t n = 0;
+    for (R_xlen_t j = 0; j < XLENGTH(list); ++j) {
+        auto e = VECTOR_ELT(list, j);
+        if (!isPlainAsciiStrings(e) &&
+            (TYPEOF(e) != INTSXP || ATTRIB(e) != R_NilValue))
+            return nullptr;
+        if (XLENGTH(e) == 0)
+            return nullptr;
+        n = std::max(n, XLENGTH(e));
+    }
+
+    SEXP res = PROTECT(Rf_allocVector(STRSXP, n));
+    std::string buf;
+    for (R_xlen_t i = 0; i < n; ++i) {
+        buf.clear();
+        for (R_xlen_t j = 0; j < XLENGTH(list); ++j) {
+            auto e = VECTOR_ELT(list, j);
+            auto k = i % XLENGTH(e);
+            if (TYPEOF(e) == STRSXP) {
+                auto c = STRING_ELT(e, k);
+                buf += c == NA_STRING ? "NA" : CHAR(c);
+            } else if (INTEGER(e)[k] == NA_INTEGER) {
+                buf += "NA";
+            } else {
+                appendFormatted(buf, "%d", INTEGER(e)[k]);
+            }
+        }
+        SET_STRING_ELT(res, i, Rf_mkCharLen(buf.data(), buf.size()));
+    }
+    UNPROTECT(1);
+    return res;
+}
+
+static SEXP stringSubstr(SEXP x, SEXP start, SEXP stop) {
+    if (!isPlainAsciiStrings(x) || TYPEOF(start) != INTSXP ||
+        TYPEOF(stop) != INTSXP || XLENGTH(start) == 0 || XLENGTH(stop) == 0)
+        return nullptr;
+    auto n = XLENGTH(x);
+    SEXP res = PROTECT(Rf_allocVector(STRSXP, n));
+    for (R_xlen_t i = 0; i < n; ++i) {
+        auto c = STRING_ELT(x, i);
+        int from = INTEGER(start)[i % XLENGTH(start)];
+        int to = INTEGER(stop)[i % XLENGTH(stop)];
+        if (c == NA_STRING || from == NA_INTEGER || to == NA_INTEGER) {
+            SET_STRING_ELT(res, i, NA_STRING);
+            continue;
+        }
+        if (from < 1)
+            from = 1;
+        if (to > LENGTH(c))
+            to = LENGTH(c);
+        if (from > to)
+            SET_STRING_ELT(res, i, R_BlankString);
+        else
+            SET_STRING_ELT(res, i,
+                           Rf_mkCharLen(CHAR(c) + from - 1, to - from + 1));
+    }
+    UNPROTECT(1);
+    return res;
+}
+
+static SEXP stringStartsOrEndsWith(SEXP x, SEXP affix, bool starts) {
+    if (!isPlainAsciiStrings(x) || !isPlainAsciiStrings(affix))
+        return nullptr;
+    auto nx = XLENGTH(x), na = XLENGTH(affix);
+    auto n = nx && na ? std::max(nx, na) : 0;
+    SEXP res = Rf_allocVector(LGLSXP, n);
+    for (R_xlen_t i = 0; i < n; ++i) {
+        auto c = STRING_ELT(x, i % nx);
+        auto a = STRING_ELT(affix, i % na);
+        if (c == NA_STRING || a == NA_STRING) {
+            LOGICAL(res)[i] = NA_LOGICAL;
+            continue;
+        }
+        auto lc = LENGTH(c), la = LENGTH(a);
+        if (la > lc) {
+            LOGICAL(res)[i] = FALSE;
+            continue;
+        }
+        auto from = starts ? CHAR(c) : CHAR(c) + lc - la;
+        LOGICAL(res)[i] = memcmp(from, CHAR(a), la) == 0;
+    }
+    return res;
+}
+
+static SEXP stringChangeCase(SEXP x, bool upper) {
+    if (!isPlainAsciiStrings(x))
+        return nullptr;
+    auto n = XLENGTH(x);
+    SEXP res = PROTECT(Rf_allocVector(STRSXP, n));
+    std::string buf;
+    for (R_xlen_t i = 0; i < n; ++i) {
+        auto c = STRING_ELT(x, i);
+        if (c == NA_STRING) {
+            SET_STRING_ELT(res, i, NA_STRING);
+            continue;
+        }
+        buf = CHAR(c);
+        for (auto& ch : buf) {
+            if (upper && ch >= 'a' && ch <= 'z')
+                ch = ch - 'a' + 'A';
+            else if (!upper && ch >= 'A' && ch <= 'Z')
+                ch = ch - 'A' + 'a';
+        }
+        SET_STRING_ELT(res, i, Rf_mkCharLen(buf.data(), buf.size()));
+    }
+    UNPROTECT(1);
+    return res;
+}
+
+// Only scalar arguments, which are used exactly once by conversions without
+// `*` widths or `n$` references. Other cases need the coercions and the
+// recycling done by R.
+static SEXP stringSprintf(size_t nargs, const SEXP* args) {
+    if (nargs < 1 || !isPlainAsciiStrings(args[0]) || XLENGTH(args[0]) != 1 ||
+        STRING_ELT(args[0], 0) == NA_STRING)
+        return nullptr;
+
+    std::string out;
+    size_t next = 1;
+    auto p = CHAR(STRING_ELT(args[0], 0));
+    while (*p) {
+        if (*p != '%') {
+            out += *p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            out += '%';
+            p += 2;
+            continue;
+        }
+        auto start = p++;
+        while (*p && strchr("-+ 0#", *p))
+            p++;
+        while (isdigit(*p))
+            p++;
+        if (*p == '.') {
+            p++;
+            while (isdigit(*p))
+                p++;
+        }
+        auto conv = *p;
+        if (!conv || next >= nargs)
+            return nullptr;
+        p++;
+        auto v = args[next++];
+        if (!Rf_isVectorAtomic(v) || XLENGTH(v) != 1 ||
+            ATTRIB(v) != R_NilValue)
+            return nullptr;
+        std::string spec(start, p - start);
+        bool ok = false;
+        switch (conv) {
+        case 'd':
+        case 'i':
+        case 'o':
+        case 'x':
+        case 'X':
+            ok = TYPEOF(v) == INTSXP && INTEGER(v)[0] != NA_INTEGER &&
+                 appendFormatted(out, spec, INTEGER(v)[0]);
+            break;
+        case 'f':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+            ok = TYPEOF(v) == REALSXP && R_FINITE(REAL(v)[0]) &&
+                 appendFormatted(out, spec, REAL(v)[0]);
+            break;
+        case 's':
+            ok = isPlainAsciiStrings(v) && STRING_ELT(v, 0) != NA_STRING &&
+                 appendFormatted(out, spec, CHAR(STRING_ELT(v, 0)));
+            break;
+        default:
+            break;
+        }
+        if (!ok)
+            return nullptr;
+    }
+    // Unused arguments are reported by R
+    if (next != nargs)
+        return nullptr;
+    return Rf_ScalarString(Rf_mkCharLen(out.data(), out.size()));
+}
+
 SEXP tryFastSpecialCall(CallContext& call) {
     auto nargs = call.passedArgs;
     switch (call.callee->u.primsxp.offset) {
@@ -201,6 +432,12 @@ SEXP tryFastSpecialCall(CallContext& call) {
                     innerCtxt.setSimpleInt(i);
                 if (call.givenContext.isSimpleReal(i + 2))
                     innerCtxt.setSimpleReal(i);
+                if (call.givenContext.isPlainNumVec(i + 2))
+                    innerCtxt.setPlainNumVec(i);
+                if (call.givenContext.isNAFree(i + 2))
+                    innerCtxt.setNAFree(i);
+                if (call.givenContext.isPlainList(i + 2))
+                    innerCtxt.setPlainList(i);
                 if (call.givenContext.isNotObj(i + 2))
                     innerCtxt.setNotObj(i);
                 if (call.givenContext.isNonRefl(i + 2))
@@ -257,7 +494,7 @@ SEXP tryFastSpecialCall(CallContext& call) {
 static constexpr size_t MAXARGS = 8;
 
 bool supportsFastBuiltinCall2(SEXP b, size_t nargs) {
-    if (nargs > 5)
+    if (nargs > MAXARGS)
         return false;
 
     // This is a blocklist of builtins which tamper with the argslist in some
@@ -342,54 +579,71 @@ static bool doesNotAccessEnv(SEXP b) {
     return pir::SafeBuiltinsList::nonObject(b->u.primsxp.offset);
 }
 
+int rhsArgPosition(SEXP b, size_t nargs) {
+    switch (b->u.primsxp.offset) {
+    case blt("length<-"):
+    case blt("oldClass<-"):
+    case blt("class<-"):
+    case blt("names<-"):
+    case blt("dimnames<-"):
+    case blt("dim<-"):
+    case blt("attributes<-"):
+    case blt("levels<-"):
+    case blt("comment<-"):
+    case blt("storage.mode<-"):
+    case blt("environment<-"):
+    case blt("parent.env<-"):
+        return nargs == 2 ? 1 : -1;
+    case blt("attr<-"):
+        return nargs == 3 ? 2 : -1;
+    case blt("substr<-"):
+        return nargs == 4 ? 3 : -1;
+    default: {
+    }
+    }
+    return -1;
+}
+
 SEXP tryFastBuiltinCall2(CallContext& call, size_t nargs,
                          SEXP (&args)[MAXARGS]) {
-    assert(nargs <= 5);
-
-    {
-        SEXP arglist;
-        CCODE f = getBuiltin(call.callee);
-        SEXP res = nullptr;
-        auto env = doesNotAccessEnv(call.callee) ? R_BaseEnv
-                                                 : materializeCallerEnv(call);
-        switch (call.passedArgs) {
-        case 0: {
-            return f(call.ast, call.callee, R_NilValue, env);
-        }
-        case 1: {
-            FAKE_ARGS1(arglist, args[0]);
-            res = f(call.ast, call.callee, arglist, env);
-            CHECK_FAKE_ARGS1();
-            break;
-        }
-        case 2: {
-            FAKE_ARGS2(arglist, args[0], args[1]);
-            res = f(call.ast, call.callee, arglist, env);
-            CHECK_FAKE_ARGS2();
-            break;
-        }
-        case 3: {
-            FAKE_ARGS3(arglist, args[0], args[1], args[2]);
-            res = f(call.ast, call.callee, arglist, env);
-            CHECK_FAKE_ARGS3();
-            break;
-        }
-        case 4: {
-            FAKE_ARGS4(arglist, args[0], args[1], args[2], args[3]);
-            res = f(call.ast, call.callee, arglist, env);
-            CHECK_FAKE_ARGS4();
-            break;
-        }
-        case 5: {
-            FAKE_ARGS5(arglist, args[0], args[1], args[2], args[3], args[4]);
-            res = f(call.ast, call.callee, arglist, env);
-            CHECK_FAKE_ARGS5();
-            break;
-        }
-        }
-        return res;
+    assert(nargs <= MAXARGS);
+
+    // The arglist is built from fake cons cells on the C stack, the arguments
+    // themselves are kept alive by the RIR stack.
+    SEXPREC cells[MAXARGS];
+    SEXP arglist = R_NilValue;
+    auto ast = call.ast;
+    for (size_t i = 0; i < nargs; ++i) {
+        ast = CDR(ast);
+        createFakeCONS(cells[i], R_NilValue);
+        cells[i].u.listsxp.carval = args[i];
+        cells[i].u.listsxp.tagval = call.hasNames() ? call.name(i) : TAG(ast);
+        if (i > 0)
+            cells[i - 1].u.listsxp.cdrval = &cells[i];
     }
-    return nullptr;
+    if (nargs > 0)
+        arglist = &cells[0];
+
+    auto rhs = rhsArgPosition(call.callee, nargs);
+    if (rhs != -1 && NAMED(args[rhs]))
+        ENSURE_NAMEDMAX(args[rhs]);
+
+    CCODE f = getBuiltin(call.callee);
+    auto env = doesNotAccessEnv(call.callee) ? R_BaseEnv
+                                             : materializeCallerEnv(call);
+    SEXP res = f(call.ast, call.callee, arglist, env);
+
+#ifdef ENABLE_SLOWASSERT
+    for (size_t i = 0; i < nargs; ++i) {
+        SLOWASSERT(cells[i].gengc_next_node == R_NilValue &&
+                   cells[i].gengc_prev_node == R_NilValue &&
+                   "broken cons gengc node");
+        SLOWASSERT(cells[i].u.listsxp.cdrval ==
+                       (i + 1 < nargs ? &cells[i + 1] : R_NilValue) &&
+                   "broken cons");
+    }
+#endif
+    return res;
 }
 
 SEXP tryFastBuiltinCall1(const CallContext& call, size_t nargs, bool hasAttrib,
@@ -1043,6 +1297,62 @@ SEXP tryFastBuiltinCall1(const CallContext& call, size_t nargs, bool hasAttrib,
             return nullptr;
         return Rf_getAttrib(args[0], R_DimNamesSymbol);
     }
+
+    case blt("paste0"): {
+        if (hasAttrib || nargs < 2 || nargs > 3 ||
+            (nargs == 3 && !IS_SIMPLE_SCALAR(args[2], LGLSXP)))
+            return nullptr;
+        return stringPaste0(args[0], args[1]);
+    }
+
+    case blt("nchar"): {
+        if (hasAttrib || nargs != 4 || !isPlainAsciiStrings(args[0]) ||
+            !(isScalarString(args[1], "chars") ||
+              isScalarString(args[1], "bytes")) ||
+            !IS_SIMPLE_SCALAR(args[3], LGLSXP))
+            return nullptr;
+        // keepNA = NA means TRUE for chars and bytes
+        bool keepNA = LOGICAL(args[3])[0] != 0;
+        auto n = XLENGTH(args[0]);
+        SEXP res = Rf_allocVector(INTSXP, n);
+        for (R_xlen_t i = 0; i < n; ++i) {
+            auto c = STRING_ELT(args[0], i);
+            if (c == NA_STRING)
+                INTEGER(res)[i] = keepNA ? NA_INTEGER : 2;
+            else
+                INTEGER(res)[i] = LENGTH(c);
+        }
+        return res;
+    }
+
+    case blt("substr"): {
+        if (hasAttrib || nargs != 3)
+            return nullptr;
+        return stringSubstr(args[0], args[1], args[2]);
+    }
+
+    case blt("startsWith"):
+    case blt("endsWith"): {
+        if (hasAttrib || nargs != 2)
+            return nullptr;
+        return stringStartsOrEndsWith(
+            args[0], args[1],
+            call.callee->u.primsxp.offset == blt("startsWith"));
+    }
+
+    case blt("toupper"):
+    case blt("tolower"): {
+        if (hasAttrib || nargs != 1)
+            return nullptr;
+        return stringChangeCase(
+            args[0], call.callee->u.primsxp.offset == blt("toupper"));
+    }
+
+    case blt("sprintf"): {
+        if (hasAttrib)
+            return nullptr;
+        return stringSprintf(nargs, args);
+    }
     }
     return nullptr;
 }
@@ -1090,6 +1400,14 @@ bool supportsFastBuiltinCall(SEXP b, size_t nargs) {
     case blt("row"):
     case blt("dim"):
     case blt("$"):
+    case blt("paste0"):
+    case blt("nchar"):
+    case blt("substr"):
+    case blt("startsWith"):
+    case blt("endsWith"):
+    case blt("toupper"):
+    case blt("tolower"):
+    case blt("sprintf"):
         return true;
     default: {
     }
@@ -1101,10 +1419,11 @@ SEXP tryFastBuiltinCall(CallContext& call) {
     SEXP args[MAXARGS];
     auto nargs = call.suppliedArgs;
 
-    if (nargs > MAXARGS || call.hasNames())
+    if (nargs > MAXARGS)
         return nullptr;
 
     bool hasAttrib = false;
+    bool hasObject = false;
     for (size_t i = 0; i < call.suppliedArgs; ++i) {
         auto arg = call.stackArg(i);
         if (TYPEOF(arg) == PROMSXP)
@@ -1113,13 +1432,17 @@ SEXP tryFastBuiltinCall(CallContext& call) {
             return nullptr;
         if (ATTRIB(arg) != R_NilValue)
             hasAttrib = true;
+        if (OBJECT(arg))
+            hasObject = true;
         args[i] = arg;
     }
 
-    if (auto res = tryFastBuiltinCall1(call, nargs, hasAttrib, args))
-        return res;
+    if (!call.hasNames())
+        if (auto res = tryFastBuiltinCall1(call, nargs, hasAttrib, args))
+            return res;
 
-    if (hasAttrib)
+    // Builtins dispatching on objects pass their arglist on to the method
+    if (hasObject)
         return nullptr;
 
     if (!supportsFastBuiltinCall2(call.callee, nargs))
@@ -8,6 +8,10 @@ namespace rir {
 SEXP tryFastSpecialCall(CallContext& call);
 SEXP tryFastBuiltinCall(CallContext& call);
 bool supportsFastBuiltinCall(SEXP blt, size_t nargs);
+// Builtins which can be called with an arglist on the C stack
+bool supportsFastBuiltinCall2(SEXP blt, size_t nargs);
+// Position of the value argument of replacement builtins, or -1
+int rhsArgPosition(SEXP blt, size_t nargs);
 
 } // namespace rir
 
@@ -4,13 +4,25 @@
 #include "R/Symbols.h"
 #include "R/r.h"
 #include "instance.h"
+#include "opcode_stats.h"
+#include "runtime/Code.h"
+#include "runtime/SpeculatedBindings.h"
+#include "utils/JitStats.h"
 
 #include <type_traits>
 
 namespace rir {
 
-// TODO: Expose this from GNU R Defn.h to remove duplication
-#define MAX_CACHE_SIZE 255
+// Baseline code keeps its locals in a GNU R frame and caches the binding cells
+// per code object. A LazyEnvironment stub would be materialized almost at once
+// in the interpreter: every promise for a call argument, and every ldfun_ and
+// guard_fun_ of a non-local function, hands the env to GNU R. Optimized code
+// does use stubs, and frame slots (see LowerFunctionLLVM::frameEnvironments),
+// where PIR proves the env does not escape.
+//
+// Number of binding cache slots per code object. Variables beyond that are
+// looked up in the frame on every access.
+#define MAX_CACHE_SIZE 1023
 #define ACTIVE_BINDING_MASK (1 << 15)
 #define BINDING_LOCK_MASK (1 << 14)
 #define IS_ACTIVE_BINDING(b) ((b)->sxpinfo.gp & ACTIVE_BINDING_MASK)
@@ -42,9 +54,9 @@ static inline SEXP cachedGetBindingCell(Immediate cacheIdx,
 }
 
 static inline void cachedSetBindingCell(Immediate cacheIdx, BindingCache* cache,
-                                        R_varloc_t loc) {
+                                        SEXP cell) {
     SLOWASSERT(cacheIdx < cache->length);
-    cache->entry[cacheIdx] = loc.cell;
+    cache->entry[cacheIdx] = cell;
 }
 
 template <typename T>
@@ -88,10 +100,11 @@ inline SEXPTYPE sexptypeOf(SEXP) {
     assert(false && "unreachable");
 }
 
+// Returns the binding cell of symbol in rho, if it can be cached
 template <typename T>
-static inline void rirDefineVarWrapper(SEXP symbol, T value, SEXP rho) {
+static inline SEXP rirDefineVarWrapper(SEXP symbol, T value, SEXP rho) {
     if (rho == R_EmptyEnv)
-        return;
+        return nullptr;
 
     if (OBJECT(rho) || HASHTAB(rho) != R_NilValue) {
         auto val = staticBox(value);
@@ -99,30 +112,33 @@ static inline void rirDefineVarWrapper(SEXP symbol, T value, SEXP rho) {
         INCREMENT_NAMED(val);
         Rf_defineVar(symbol, val, rho);
         UNPROTECT(1);
-        return;
+        if (OBJECT(rho))
+            return nullptr;
+        return R_findVarLocInFrame(rho, symbol).cell;
     }
 
     constexpr auto unboxed = !std::is_same<T, SEXP>::value;
     if (rho == R_BaseNamespace || rho == R_BaseEnv) {
+        SpeculatedBindings::invalidate(symbol);
         auto cur = SYMVALUE(symbol);
         if (unboxed) {
             if (IS_SIMPLE_SCALAR(cur, sexptypeOf(value)) &&
                 !MAYBE_SHARED(cur)) {
                 ENSURE_NAMED(cur);
                 updateScalar(cur, value);
-                return;
+                return nullptr;
             }
         }
         auto val = staticBox(value);
         if (!unboxed && SYMVALUE(symbol) == val) {
             ENSURE_NAMED(val);
-            return;
+            return nullptr;
         }
         INCREMENT_NAMED(val);
         PROTECT(val);
         Rf_defineVar(symbol, val, rho);
         UNPROTECT(1);
-        return;
+        return nullptr;
     }
 
     if (IS_SPECIAL_SYMBOL(symbol))
@@ -141,13 +157,13 @@ static inline void rirDefineVarWrapper(SEXP symbol, T value, SEXP rho) {
                     // must be done always
                     ENSURE_NAMED(cur);
                     updateScalar(cur, value);
-                    return;
+                    return frame;
                 }
             }
             auto val = staticBox(value);
             if (!unboxed && cur == val) {
                 ENSURE_NAMED(cur);
-                return;
+                return frame;
             }
             INCREMENT_NAMED(val);
             // we don't handle these
@@ -155,11 +171,11 @@ static inline void rirDefineVarWrapper(SEXP symbol, T value, SEXP rho) {
                 PROTECT(val);
                 Rf_defineVar(symbol, val, rho);
                 UNPROTECT(1);
-                return;
+                return nullptr;
             }
             SETCAR(frame, val);
             SET_MISSING(frame, 0); /* Over-ride */
-            return;
+            return frame;
         }
         frame = CDR(frame);
     }
@@ -172,6 +188,7 @@ static inline void rirDefineVarWrapper(SEXP symbol, T value, SEXP rho) {
     SET_FRAME(rho, Rf_cons(val, FRAME(rho)));
     UNPROTECT(1);
     SET_TAG(FRAME(rho), symbol);
+    return FRAME(rho);
 }
 
 static inline SEXP getCellFromCache(SEXP env, Immediate poolIdx,
@@ -179,14 +196,16 @@ static inline SEXP getCellFromCache(SEXP env, Immediate poolIdx,
     if (env != R_BaseEnv && env != R_BaseNamespace) {
         SEXP cell = cachedGetBindingCell(cacheIdx, cache);
         if (!cell) {
+            OPCODE_STATS(JitStats::bindingCacheMisses++);
             SEXP sym = cp_pool_at(poolIdx);
             SLOWASSERT(TYPEOF(sym) == SYMSXP);
             R_varloc_t loc = R_findVarLocInFrame(env, sym);
             if (!R_VARLOC_IS_NULL(loc)) {
-                cachedSetBindingCell(cacheIdx, cache, loc);
+                cachedSetBindingCell(cacheIdx, cache, loc.cell);
                 return loc.cell;
             }
         } else {
+            OPCODE_STATS(JitStats::bindingCacheHits++);
             return cell;
         }
     }
@@ -229,15 +248,63 @@ static inline void cachedSetVar(SEXP val, SEXP env, Immediate poolIdx,
 
     SEXP sym = cp_pool_at(poolIdx);
     SLOWASSERT(TYPEOF(sym) == SYMSXP);
-    rirDefineVarWrapper(sym, val, env);
+    // Newly created bindings go into the cache right away, so that following
+    // accesses do not have to search the frame again
+    if (auto cell = rirDefineVarWrapper(sym, val, env))
+        cachedSetBindingCell(cacheIdx, cache, cell);
+}
+
+// Super assignments and lookups in the parent frame remember the binding cells
+// they found in the frame of the parent, per code object. Only cells of the
+// frame itself are cached, thus bindings in other frames cannot shadow them.
+// Removed bindings are left behind as unbound cells, which fail the check.
+#define SUPER_BINDING_CACHE_SIZE 8
+
+// Same as R_findVarLocInFrame(env, sym).cell
+static inline SEXP superBindingCell(Code* c, SEXP env, SEXP sym) {
+    if (!c || OBJECT(env))
+        return R_findVarLocInFrame(env, sym).cell;
+
+    size_t slot = ((uintptr_t)sym >> 4) % SUPER_BINDING_CACHE_SIZE;
+    SEXP cache = c->superBindingCache();
+    if (cache && VECTOR_ELT(cache, 2 * slot) == env) {
+        SEXP cell = VECTOR_ELT(cache, 2 * slot + 1);
+        if (TAG(cell) == sym && CAR(cell) != R_UnboundValue)
+            return cell;
+    }
+
+    SEXP cell = R_findVarLocInFrame(env, sym).cell;
+    if (cell && !IS_ACTIVE_BINDING(cell)) {
+        if (!cache) {
+            cache = Rf_allocVector(VECSXP, 2 * SUPER_BINDING_CACHE_SIZE);
+            c->superBindingCache(cache);
+        }
+        SET_VECTOR_ELT(cache, 2 * slot, env);
+        SET_VECTOR_ELT(cache, 2 * slot + 1, cell);
+    }
+    return cell;
 }
 
-static inline void rirSetVarWrapper(SEXP sym, SEXP val, SEXP env) {
+// Rf_findVar starting at the parent env
+static inline SEXP cachedGetSuperVar(Code* c, SEXP sym, SEXP env) {
+    if (env != R_BaseEnv && env != R_BaseNamespace && env != R_EmptyEnv) {
+        SEXP cell = superBindingCell(c, env, sym);
+        if (cell && !IS_ACTIVE_BINDING(cell) && CAR(cell) != R_UnboundValue)
+            return CAR(cell);
+    }
+    return Rf_findVar(sym, env);
+}
+
+static inline void rirSetVarWrapper(SEXP sym, SEXP val, SEXP env,
+                                    Code* c = nullptr) {
     if (env != R_BaseEnv && env != R_BaseNamespace) {
-        R_varloc_t loc = R_findVarLocInFrame(env, sym);
-        if (!R_VARLOC_IS_NULL(loc) && !BINDING_IS_LOCKED(loc.cell) &&
-            !IS_ACTIVE_BINDING(loc.cell)) {
-            SEXP cur = CAR(loc.cell);
+        // The first lookup allocates the cache, val might be unreachable
+        // (callers pop it off the stack before storing)
+        PROTECT(val);
+        SEXP cell = superBindingCell(c, env, sym);
+        UNPROTECT(1);
+        if (cell && !BINDING_IS_LOCKED(cell) && !IS_ACTIVE_BINDING(cell)) {
+            SEXP cur = CAR(cell);
             if (cur == val) {
                 // subassign.c primitives and instructions clear the name
                 // expecting a store to happen later Thus, the increment must be
@@ -246,15 +313,19 @@ static inline void rirSetVarWrapper(SEXP sym, SEXP val, SEXP env) {
                 return;
             }
             INCREMENT_NAMED(val);
-            SETCAR(loc.cell, val);
-            SET_MISSING(loc.cell, 0);
+            SETCAR(cell, val);
+            SET_MISSING(cell, 0);
             return;
         }
     }
+    SEXP base = SYMVALUE(sym);
     PROTECT(val);
     INCREMENT_NAMED(val);
     Rf_setVar(sym, val, ENCLOS(env));
     UNPROTECT(1);
+    // The lookup reached the (unlocked) base binding
+    if (SYMVALUE(sym) != base)
+        SpeculatedBindings::invalidate(sym);
 }
 
 } // namespace rir
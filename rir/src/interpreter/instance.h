@@ -106,6 +106,25 @@ inline void ostack_set_cell(R_bcstack_t* cell, SEXP v) {
 
 inline void ostack_set(int i, SEXP v) { ostack_set_cell(ostack_cell_at(i), v); }
 
+// Native code may pass scalar call arguments unboxed in tagged cells. Boxes
+// such a cell in place, before it can be read as a SEXP.
+inline SEXP ostack_box_cell(R_bcstack_t* cell) {
+    switch (cell->tag) {
+    case INTSXP:
+        ostack_set_cell(cell, Rf_ScalarInteger(cell->u.ival));
+        break;
+    case REALSXP:
+        ostack_set_cell(cell, Rf_ScalarReal(cell->u.dval));
+        break;
+    case LGLSXP:
+        ostack_set_cell(cell, Rf_ScalarLogical(cell->u.ival));
+        break;
+    default:
+        assert(cell->tag == 0);
+    }
+    return cell->u.sxpval;
+}
+
 inline void ostack_popn(size_t n) { R_BCNodeStackTop -= n; }
 
 inline SEXP ostack_pop() { return (--R_BCNodeStackTop)->u.sxpval; }
@@ -9,14 +9,17 @@
 #include "compiler/osr.h"
 #include "compiler/parameter.h"
 #include "compiler/pir/continuation_context.h"
+#include "opcode_stats.h"
 #include "runtime/Deoptimization.h"
 #include "runtime/LazyArglist.h"
 #include "runtime/LazyEnvironment.h"
 #include "runtime/TypeFeedback_inl.h"
 #include "safe_force.h"
+#include "utils/JitStats.h"
 #include "utils/Pool.h"
 #include "utils/measuring.h"
 
+#include <algorithm>
 #include <assert.h>
 #include <deque>
 #include <libintl.h>
@@ -86,6 +89,12 @@ static void printInterp(Opcode* pc, Code* c) {
 static void printLastop() { std::cout << "> lastop\n"; }
 #endif
 
+// Keep the top of the operand stack in a local between some instructions,
+// see NEXT_CACHED. Disabled when tracing, since cached dispatch bypasses NEXT.
+#if !defined(NO_TOS_CACHING) && !defined(PRINT_INTERP)
+#define TOS_CACHING
+#endif
+
 static SEXP getSrcAt(Code* c, Opcode* pc) {
     unsigned sidx = c->getSrcIdxAt(pc, true);
     if (sidx == 0)
@@ -129,8 +138,29 @@ static SEXP getSrcForCall(Code* c, Opcode* pc) {
         assert(false && "wrong or unimplemented opcode")
 #endif
 
+#ifdef TOS_CACHING
+// Finish the current instruction with `val` on top of the stack, but keep it
+// in the `tos` local instead of pushing it. The next instruction is dispatched
+// from the tosCached block, which either consumes `tos` directly or spills it.
+#define NEXT_CACHED(val)                                                       \
+    do {                                                                       \
+        tos = (val);                                                           \
+        goto tosCached;                                                        \
+    } while (false)
+#else
+#define NEXT_CACHED(val)                                                       \
+    do {                                                                       \
+        ostack_push(val);                                                      \
+        NEXT();                                                                \
+    } while (false)
+#endif
+
 // bytecode accesses
+#ifdef RIR_OPCODE_STATS
+#define advanceOpcode() (OpcodeStats::dispatch(*(pc++)))
+#else
 #define advanceOpcode() (*(pc++))
+#endif
 #define readImmediate() (*(Immediate*)pc)
 #define readSignedImmediate() (*(SignedImmediate*)pc)
 #define readJumpOffset() (*(JumpOffset*)(pc))
@@ -553,9 +583,183 @@ static void loopTrampoline(Code* c, SEXP env, const CallContext* callCtxt,
     Rf_endcontext(&cntxt);
 }
 
+/*
+ * Rf_matchArgs_NR only looks at the tags of the formals and at the names of
+ * the supplied arguments. We remember the resulting permutation, keyed on
+ * both, and replay it on the stack values of the next call with the same
+ * shape, without creating the intermediate pairlist. Entries are found by the
+ * identity of the formals and of the call site's names, but are validated by
+ * comparing the symbols themselves, which are never collected.
+ */
+class ArgMatchCache {
+    static constexpr size_t SIZE = 256;
+    static constexpr ArglistOrder::ArgIdx UNMATCHED = -1;
+
+    struct Entry {
+        std::vector<SEXP> formals;
+        std::vector<SEXP> names;
+        // For each formal the index of the supplied argument or UNMATCHED
+        ArglistOrder::CallArglistOrder order;
+        // Supplied arguments collected by the dots formal at dotsPos
+        ArglistOrder::CallArglistOrder dots;
+        size_t dotsPos = UNMATCHED;
+        bool dotsMissing = false;
+    };
+    Entry entries[SIZE];
+
+    static SEXP name(const CallContext& call, SEXP& ast, size_t i) {
+        ast = CDR(ast);
+        return call.names ? call.name(i) : TAG(ast);
+    }
+
+    static Entry& slot(ArgMatchCache& cache, const CallContext& call) {
+        auto key = (uintptr_t)FORMALS(call.callee) ^
+                   (call.names ? (uintptr_t)call.names : (uintptr_t)call.ast);
+        return cache.entries[(key >> 4) % SIZE];
+    }
+
+    static bool matches(const Entry& e, const CallContext& call) {
+        if (e.names.size() != call.suppliedArgs || e.formals.empty())
+            return false;
+        auto f = FORMALS(call.callee);
+        for (auto tag : e.formals) {
+            if (f == R_NilValue || TAG(f) != tag)
+                return false;
+            f = CDR(f);
+        }
+        if (f != R_NilValue)
+            return false;
+        auto ast = call.ast;
+        for (size_t i = 0; i < call.suppliedArgs; ++i)
+            if (name(call, ast, i) != e.names[i])
+                return false;
+        return true;
+    }
+
+    static SEXP arg(const CallContext& call, ArglistOrder::ArgIdx i) {
+        auto v = call.stackArg(i);
+        if (TYPEOF(v) != PROMSXP)
+            ENSURE_NAMED(v);
+        return v;
+    }
+
+  public:
+    static ArgMatchCache& instance() {
+        static ArgMatchCache cache;
+        return cache;
+    }
+
+    // Returns the matched actuals for the stack arguments of call, or nullptr
+    SEXP lookup(const CallContext& call) {
+        auto& e = slot(*this, call);
+        if (!matches(e, call))
+            return nullptr;
+
+        SEXP actuals = PROTECT(Rf_allocList(e.order.size()));
+        auto a = actuals;
+        for (size_t pos = 0; pos < e.order.size(); ++pos) {
+            if (pos == e.dotsPos) {
+                SET_MISSING(a, e.dotsMissing);
+                if (!e.dots.empty()) {
+                    auto dots = Rf_allocList(e.dots.size());
+                    SET_TYPEOF(dots, DOTSXP);
+                    SETCAR(a, dots);
+                    for (auto i : e.dots) {
+                        SETCAR(dots, arg(call, i));
+                        SET_TAG(dots, e.names[i]);
+                        dots = CDR(dots);
+                    }
+                } else {
+                    SETCAR(a, R_MissingArg);
+                }
+            } else {
+                auto i = e.order[pos];
+                auto v = i == UNMATCHED ? R_MissingArg : arg(call, i);
+                SETCAR(a, v);
+                SET_MISSING(a, v == R_MissingArg);
+            }
+            a = CDR(a);
+        }
+        UNPROTECT(1);
+        return actuals;
+    }
+
+    // Records how the supplied pairlist (created from the stack arguments of
+    // call) was matched to actuals. Matches which depend on the values, or
+    // which are partial and could warn, are not recorded.
+    void record(const CallContext& call, SEXP supplied, SEXP actuals) {
+        Entry e;
+        std::vector<SEXP> values;
+        auto ast = call.ast;
+        for (auto s = supplied; s != R_NilValue; s = CDR(s)) {
+            auto v = CAR(s);
+            if (v == R_MissingArg ||
+                std::find(values.begin(), values.end(), v) != values.end())
+                return;
+            values.push_back(v);
+            e.names.push_back(name(call, ast, e.names.size()));
+        }
+        if (values.size() != call.suppliedArgs)
+            return;
+        auto indexOf = [&](SEXP v) -> ArglistOrder::ArgIdx {
+            auto i = std::find(values.begin(), values.end(), v);
+            return i == values.end() ? UNMATCHED : i - values.begin();
+        };
+
+        auto a = actuals;
+        for (auto f = FORMALS(call.callee); f != R_NilValue; f = CDR(f)) {
+            auto v = CAR(a);
+            if (TAG(f) == R_DotsSymbol) {
+                e.dotsPos = e.order.size();
+                e.dotsMissing = MISSING(a);
+                if (TYPEOF(v) == DOTSXP) {
+                    for (; v != R_NilValue; v = CDR(v)) {
+                        auto i = indexOf(CAR(v));
+                        if (i == UNMATCHED || TAG(v) != e.names[i])
+                            return;
+                        e.dots.push_back(i);
+                    }
+                } else if (v != R_MissingArg) {
+                    return;
+                }
+                e.order.push_back(UNMATCHED);
+            } else {
+                auto i = v == R_MissingArg ? UNMATCHED : indexOf(v);
+                if (v != R_MissingArg && i == UNMATCHED)
+                    return;
+                if (i != UNMATCHED && e.names[i] != R_NilValue &&
+                    e.names[i] != TAG(f))
+                    return;
+                if ((bool)MISSING(a) != (v == R_MissingArg))
+                    return;
+                e.order.push_back(i);
+            }
+            e.formals.push_back(TAG(f));
+            a = CDR(a);
+        }
+        if (e.formals.empty())
+            return;
+        slot(*this, call) = std::move(e);
+    }
+};
+
+static SEXP matchStackArgs(const CallContext& call) {
+    auto& cache = ArgMatchCache::instance();
+    if (auto actuals = cache.lookup(call))
+        return actuals;
+
+    SEXP supplied = PROTECT(createEnvironmentFrameFromStackValues(
+        const_cast<CallContext&>(call)));
+    SEXP actuals =
+        PROTECT(Rf_matchArgs_NR(FORMALS(call.callee), supplied, call.ast));
+    cache.record(call, supplied, actuals);
+    UNPROTECT(2);
+    return actuals;
+}
+
 static SEXP closureArgumentAdaptor(const CallContext& call, SEXP arglist) {
     SEXP op = call.callee;
-    if (FORMALS(op) == R_NilValue && arglist == R_NilValue)
+    if (FORMALS(op) == R_NilValue && call.suppliedArgs == 0)
         return Rf_NewEnvironment(R_NilValue, R_NilValue, CLOENV(op));
 
     /*  Set up a context with the call in it so error has access to it */
@@ -573,8 +777,14 @@ static SEXP closureArgumentAdaptor(const CallContext& call, SEXP arglist) {
 
     bool noArgmatchNeeded =
         call.givenContext.includes(Assumption::StaticallyArgmatched);
-    if (!noArgmatchNeeded)
-        actuals = Rf_matchArgs_NR(FORMALS(op), actuals, call.ast);
+    assert(!noArgmatchNeeded || call.arglist);
+    if (!noArgmatchNeeded) {
+        // Without an arglist, arglist is only the lazy promargs of the call
+        if (call.arglist)
+            actuals = Rf_matchArgs_NR(FORMALS(op), actuals, call.ast);
+        else
+            actuals = matchStackArgs(call);
+    }
 
     PROTECT(newrho = Rf_NewEnvironment(FORMALS(op), actuals, CLOENV(op)));
 
@@ -663,6 +873,50 @@ SEXP getTrivialPromValue(SEXP sym, SEXP env) {
     return R_UnboundValue;
 }
 
+bool matchConstantArgs(const CallContext& call, bool record) {
+    auto table = DispatchTable::unpack(BODY(call.callee));
+    auto baseline = table->baseline();
+    auto& sig = baseline->signature();
+
+    size_t n = Function::MAX_CONSTANT_ARGS;
+    if (call.suppliedArgs < n)
+        n = call.suppliedArgs;
+    if (baseline->nargs() < n)
+        n = baseline->nargs();
+    // Args after the dots do not end up in their formal's position
+    if (sig.hasDotsFormals && sig.dotsPosition < n)
+        n = sig.dotsPosition;
+
+    bool matches = true;
+    bool anyConstant = false;
+    bool invalidated = false;
+    for (size_t i = 0; i < n; ++i) {
+        auto arg = call.stackArg(i);
+        if (record && baseline->recordArgValue(i, arg))
+            invalidated = true;
+        if (auto c = baseline->constantArg(i)) {
+            anyConstant = true;
+            if (!Function::sameConstant(c, arg))
+                matches = false;
+        }
+    }
+    for (size_t i = n; i < Function::MAX_CONSTANT_ARGS; ++i)
+        if (baseline->constantArg(i))
+            matches = false;
+
+    // Versions specialized on the old constant are not valid anymore
+    if (invalidated) {
+        for (size_t i = 1; i < table->size(); ++i) {
+            auto f = table->get(i);
+            if (f->context().getTypeFlags().includes(
+                    TypeAssumption::ConstantArgs_))
+                f->flags.set(Function::Deopt);
+        }
+    }
+
+    return matches && anyConstant;
+}
+
 void inferCurrentContext(CallContext& call, size_t formalNargs) {
     Context& given = call.givenContext;
 
@@ -683,15 +937,16 @@ void inferCurrentContext(CallContext& call, size_t formalNargs) {
 
     given.add(Assumption::NoExplicitlyMissingArgs);
 
-    auto testArg = [&](size_t i) {
+    // Infers the assumptions of arg i into slot `pos` of `ctx`
+    auto testArg = [&](size_t i, Context& ctx, size_t pos) {
         SEXP arg = call.stackArg(i);
         bool isEager = true;
 
         // An explicitly missing arg, such as f(,1)
         if (arg == R_MissingArg) {
             given.remove(Assumption::NoExplicitlyMissingArgs);
-            given.setNonRefl(i);
-            given.setEager(i);
+            ctx.setNonRefl(pos);
+            ctx.setEager(pos);
             return;
         }
 
@@ -751,11 +1006,11 @@ void inferCurrentContext(CallContext& call, size_t formalNargs) {
         assert(TYPEOF(arg) != PROMSXP);
 
         if (!reflectionPossible) {
-            given.setNonRefl(i);
+            ctx.setNonRefl(pos);
         }
 
         if (isEager) {
-            given.setEager(i);
+            ctx.setEager(pos);
             SLOWASSERT(TYPEOF(call.stackArg(i)) != PROMSXP ||
                        PRVALUE(call.stackArg(i)) != R_UnboundValue);
         }
@@ -764,15 +1019,12 @@ void inferCurrentContext(CallContext& call, size_t formalNargs) {
         // expression, given no reflective change happens.
         if (arg != R_UnboundValue && arg != R_MissingArg) {
             if (!Rf_isObject(arg))
-                given.setNotObj(i);
-            if (IS_SIMPLE_SCALAR(arg, REALSXP))
-                given.setSimpleReal(i);
-            if (IS_SIMPLE_SCALAR(arg, INTSXP))
-                given.setSimpleInt(i);
+                ctx.setNotObj(pos);
+            ctx.setValueShape(pos, arg);
         }
 
         if (arg == R_MissingArg)
-            given.resetNotObj(i);
+            ctx.resetNotObj(pos);
     };
 
     bool tryArgmatch = !given.includes(Assumption::StaticallyArgmatched);
@@ -785,7 +1037,13 @@ void inferCurrentContext(CallContext& call, size_t formalNargs) {
 
     SEXP formals = FORMALS(call.callee);
     for (size_t i = 0; i < call.suppliedArgs; ++i) {
-        testArg(i);
+        if (i < Context::NUM_TYPED_ARGS) {
+            testArg(i, given, i);
+        } else {
+            Context arg;
+            testArg(i, arg, 0);
+            given.addRestArg(i, arg);
+        }
         if (call.hasNames()) {
             auto name = call.name(i);
             if (name != R_NilValue && name != TAG(formals)) {
@@ -796,6 +1054,10 @@ void inferCurrentContext(CallContext& call, size_t formalNargs) {
             formals = CDR(formals);
         }
     }
+
+    if (given.includes(Assumption::CorrectOrderOfArguments) &&
+        matchConstantArgs(call, true))
+        given = given | Context::TypeFlags(TypeAssumption::ConstantArgs_);
 }
 
 // Watch out: this changes call.nargs! To clean up after the call, you need to
@@ -861,10 +1123,14 @@ SEXP doCall(CallContext& call, bool popArgs) {
 
     case SPECIALSXP: {
         if (SEXP res = tryFastSpecialCall(call)) {
+            OPCODE_STATS(
+                OpcodeStats::fastPath(getBuiltinNr(call.callee), true));
             if (popArgs)
                 ostack_popn(call.passedArgs - call.suppliedArgs);
             return res;
         }
+        OPCODE_STATS(
+            OpcodeStats::fastPath(getBuiltinNr(call.callee), false));
 #ifdef DEBUG_SLOWCASES
         SlowcaseCounter::count("special", call);
 #endif
@@ -886,6 +1152,8 @@ SEXP doCall(CallContext& call, bool popArgs) {
 
     case BUILTINSXP: {
         if (SEXP res = tryFastBuiltinCall(call)) {
+            OPCODE_STATS(
+                OpcodeStats::fastPath(getBuiltinNr(call.callee), true));
             int flag = getFlag(call.callee);
             if (flag < 2)
                 R_Visible = static_cast<Rboolean>(flag != 1);
@@ -893,6 +1161,8 @@ SEXP doCall(CallContext& call, bool popArgs) {
                 ostack_popn(call.passedArgs - call.suppliedArgs);
             return res;
         }
+        OPCODE_STATS(
+            OpcodeStats::fastPath(getBuiltinNr(call.callee), false));
 #ifdef DEBUG_SLOWCASES
         SlowcaseCounter::count("builtin", call);
 #endif
@@ -902,41 +1172,11 @@ SEXP doCall(CallContext& call, bool popArgs) {
 
         // Make sure the RHS NAMED value is 0 or NAMEDMAX for when the RHS value
         // is part of the LHS object. See FIXUP_RHS_NAMED in eval.c
-        switch (call.callee->u.primsxp.offset) {
-        case blt("length<-"):
-        case blt("oldClass<-"):
-        case blt("class<-"):
-        case blt("names<-"):
-        case blt("dimnames<-"):
-        case blt("dim<-"):
-        case blt("attributes<-"):
-        case blt("levels<-"):
-        case blt("comment<-"):
-        case blt("storage.mode<-"):
-        case blt("environment<-"):
-        case blt("parent.env<-"): {
-            if (call.passedArgs == 2) {
-                if (NAMED(CADR(arglist)))
-                    ENSURE_NAMEDMAX(CADR(arglist));
-            }
-            break;
-        }
-        case blt("attr<-"): {
-            if (call.passedArgs == 3) {
-                if (NAMED(CADDR(arglist)))
-                    ENSURE_NAMEDMAX(CADDR(arglist));
-            }
-            break;
-        }
-        case blt("substr<-"): {
-            if (call.passedArgs == 4) {
-                if (NAMED(CADDDR(arglist)))
-                    ENSURE_NAMEDMAX(CADDDR(arglist));
-            }
-            break;
-        }
-        default: {
-        }
+        auto rhs = rhsArgPosition(call.callee, call.passedArgs);
+        if (rhs != -1) {
+            auto v = CAR(Rf_nthcdr(arglist, rhs));
+            if (NAMED(v))
+                ENSURE_NAMEDMAX(v);
         }
 
         CCODE f = getBuiltin(call.callee);
@@ -1045,21 +1285,26 @@ SEXP doCall(CallContext& call, bool popArgs) {
             // promargs, which we will create lazily if it does not exist yet.
             SEXP frame;
             SEXP promargs;
+            bool staticallyArgmatched =
+                call.givenContext.includes(Assumption::StaticallyArgmatched);
             if (call.arglist) {
                 promargs = call.arglist;
                 frame = Rf_shallow_duplicate(promargs);
                 PROTECT(promargs);
                 npreserved++;
-            } else {
+            } else if (staticallyArgmatched) {
                 // Wrap the passed args in a linked-list.
                 frame = createEnvironmentFrameFromStackValues(call);
                 PROTECT(frame);
                 npreserved++;
                 promargs = lazyPromargs.asSexp();
+            } else {
+                // The args are matched directly from the stack
+                frame = promargs = lazyPromargs.asSexp();
             }
 
             SEXP env;
-            if (call.givenContext.includes(Assumption::StaticallyArgmatched)) {
+            if (staticallyArgmatched) {
                 // Statically argmatched means that we can directly bundle the
                 // list of arguments with the formals, since they are already in
                 // the correct order.
@@ -1475,6 +1720,146 @@ static R_INLINE int R_integer_uminus(int x, Rboolean* pnaflag) {
         BINOP_FALLBACK(#op);                                                   \
     } while (false)
 
+/*
+ * Quickening, see BC_quickened_list.h. Inside an instruction `pc - 1` is the
+ * position of the current opcode. QUICKEN_BINOP has to run before the
+ * operands are consumed.
+ */
+#define QUICKEN_BINOP(op)                                                      \
+    do {                                                                       \
+        if (IS_SIMPLE_SCALAR(lhs, INTSXP) && IS_SIMPLE_SCALAR(rhs, INTSXP))    \
+            *(pc - 1) = Opcode::op##int_;                                      \
+        else if (IS_SIMPLE_SCALAR(lhs, REALSXP) &&                             \
+                 IS_SIMPLE_SCALAR(rhs, REALSXP))                               \
+            *(pc - 1) = Opcode::op##real_;                                     \
+    } while (false)
+
+// Rewrite back to the generic instruction and re-execute it
+#define DEQUICKEN(op)                                                          \
+    do {                                                                       \
+        *(pc - 1) = Opcode::op;                                                \
+        pc--;                                                                  \
+        NEXT();                                                                \
+    } while (false)
+
+// Result cell for a quickened binop, both operands have the result type. The
+// operands are not needed anymore at this point and can be unprotected.
+static SEXP quickBinopResult(SEXPTYPE type, SEXP lhs, SEXP rhs) {
+    if (NO_REFERENCES(lhs))
+        return lhs;
+    if (NO_REFERENCES(rhs))
+        return rhs;
+    return Rf_allocVector(type, 1);
+}
+
+/*
+ * The quick binops exist in two flavors, operating either on the two topmost
+ * stack slots, or on the topmost slot and the cached `tos` (see NEXT_CACHED).
+ */
+#define QUICK_INT_ARITH_(fun, getLhs, getRhs, npop, onMismatch)                \
+    do {                                                                       \
+        SEXP lhs = getLhs;                                                     \
+        SEXP rhs = getRhs;                                                     \
+        if (!IS_SIMPLE_SCALAR(lhs, INTSXP) || !IS_SIMPLE_SCALAR(rhs, INTSXP))  \
+            onMismatch;                                                        \
+        Rboolean naflag = FALSE;                                               \
+        int int_res = fun(*INTEGER(lhs), *INTEGER(rhs), &naflag);              \
+        SEXP res = quickBinopResult(INTSXP, lhs, rhs);                         \
+        *INTEGER(res) = int_res;                                               \
+        CHECK_INTEGER_OVERFLOW(res, naflag);                                   \
+        ostack_popn(npop);                                                     \
+        R_Visible = (Rboolean) true;                                           \
+        NEXT_CACHED(res);                                                      \
+    } while (false)
+
+#define QUICK_REAL_ARITH_(aop, getLhs, getRhs, npop, onMismatch)               \
+    do {                                                                       \
+        SEXP lhs = getLhs;                                                     \
+        SEXP rhs = getRhs;                                                     \
+        if (!IS_SIMPLE_SCALAR(lhs, REALSXP) ||                                 \
+            !IS_SIMPLE_SCALAR(rhs, REALSXP))                                   \
+            onMismatch;                                                        \
+        double real_res = (*REAL(lhs) == NA_REAL || *REAL(rhs) == NA_REAL)     \
+                              ? NA_REAL                                        \
+                              : *REAL(lhs) aop * REAL(rhs);                    \
+        SEXP res = quickBinopResult(REALSXP, lhs, rhs);                        \
+        *REAL(res) = real_res;                                                 \
+        ostack_popn(npop);                                                     \
+        R_Visible = (Rboolean) true;                                           \
+        NEXT_CACHED(res);                                                      \
+    } while (false)
+
+#define QUICK_RELOP_(type, accessor, na, rop, getLhs, getRhs, npop,           \
+                     onMismatch)                                               \
+    do {                                                                       \
+        SEXP lhs = getLhs;                                                     \
+        SEXP rhs = getRhs;                                                     \
+        if (!IS_SIMPLE_SCALAR(lhs, type) || !IS_SIMPLE_SCALAR(rhs, type))      \
+            onMismatch;                                                        \
+        SEXP res;                                                              \
+        if (*accessor(lhs) == na || *accessor(rhs) == na)                      \
+            res = R_LogicalNAValue;                                            \
+        else                                                                   \
+            res = *accessor(lhs) rop * accessor(rhs) ? R_TrueValue             \
+                                                     : R_FalseValue;           \
+        ostack_popn(npop);                                                     \
+        NEXT_CACHED(res);                                                      \
+    } while (false)
+
+#define QUICK_INT_ARITH(op, fun)                                               \
+    QUICK_INT_ARITH_(fun, ostack_at(1), ostack_at(0), 2, DEQUICKEN(op))
+#define QUICK_REAL_ARITH(op, aop)                                              \
+    QUICK_REAL_ARITH_(aop, ostack_at(1), ostack_at(0), 2, DEQUICKEN(op))
+#define QUICK_RELOP(op, type, accessor, na, rop)                               \
+    QUICK_RELOP_(type, accessor, na, rop, ostack_at(1), ostack_at(0), 2,       \
+                 DEQUICKEN(op))
+
+#ifdef TOS_CACHING
+// Spill `tos` and re-dispatch the current instruction on the stack, where the
+// quick binop will dequicken itself
+#define SPILL_TOS_AND_RETRY()                                                  \
+    do {                                                                       \
+        ostack_push(tos);                                                      \
+        pc--;                                                                  \
+        NEXT();                                                                \
+    } while (false)
+
+#define CACHED_INT_ARITH(fun)                                                  \
+    QUICK_INT_ARITH_(fun, ostack_at(0), tos, 1, SPILL_TOS_AND_RETRY())
+#define CACHED_REAL_ARITH(aop)                                                 \
+    QUICK_REAL_ARITH_(aop, ostack_at(0), tos, 1, SPILL_TOS_AND_RETRY())
+#define CACHED_RELOP(type, accessor, na, rop)                                  \
+    QUICK_RELOP_(type, accessor, na, rop, ostack_at(0), tos, 1,                \
+                 SPILL_TOS_AND_RETRY())
+#endif
+
+static bool canFuseWithPush(SEXP constant, Opcode next) {
+    switch (next) {
+    case Opcode::add_int_:
+    case Opcode::sub_int_:
+    case Opcode::mul_int_:
+    case Opcode::eq_int_:
+    case Opcode::ne_int_:
+    case Opcode::lt_int_:
+    case Opcode::le_int_:
+    case Opcode::gt_int_:
+    case Opcode::ge_int_:
+        return IS_SIMPLE_SCALAR(constant, INTSXP);
+    case Opcode::add_real_:
+    case Opcode::sub_real_:
+    case Opcode::mul_real_:
+    case Opcode::eq_real_:
+    case Opcode::ne_real_:
+    case Opcode::lt_real_:
+    case Opcode::le_real_:
+    case Opcode::gt_real_:
+    case Opcode::ge_real_:
+        return IS_SIMPLE_SCALAR(constant, REALSXP);
+    default:
+        return false;
+    }
+}
+
 SEXP seq_int(int n1, int n2) {
     int n = n1 <= n2 ? n2 - n1 + 1 : n1 - n2 + 1;
     SEXP ans = Rf_allocVector(INTSXP, n);
@@ -1897,6 +2282,7 @@ static SEXP osr(const CallContext* callCtxt, R_bcstack_t* basePtr, SEXP env,
             l <= (long)pir::ContinuationContext::MAX_ENV) {
             pir::ContinuationContext ctx(pc, env, true, basePtr, size);
             if (auto fun = pir::OSR::compile(callCtxt->callee, c, ctx)) {
+                JitStats::osrEntries++;
                 PROTECT(fun->container());
                 dt->baseline()->flags.set(Function::Flag::MarkOpt);
                 auto code = fun->body();
@@ -1919,8 +2305,13 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
     auto native = c->nativeCode();
     assert((!initialPC || !native) && "Cannot jump into native code");
     if (native) {
-        return native(c, callCtxt ? (void*)callCtxt->stackArgs : nullptr, env,
-                      callCtxt ? callCtxt->callee : nullptr);
+        // The native code is freed with its Code object, which could lose its
+        // last reference (e.g. its dispatch table slot) while it is running
+        PROTECT(c->container());
+        auto res = native(c, callCtxt ? (void*)callCtxt->stackArgs : nullptr,
+                          env, callCtxt ? callCtxt->callee : nullptr);
+        UNPROTECT(1);
+        return res;
     }
 
 #ifdef THREADED_CODE
@@ -2001,6 +2392,13 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
             feedback->stateBeforeLastForce = state;
     };
 
+#ifdef TOS_CACHING
+    // Logical top of stack while dispatching from tosCached, see NEXT_CACHED.
+    // It is not visible to the GC, so it must be consumed or spilled before
+    // anything can allocate.
+    SEXP tos = nullptr;
+#endif
+
     // main loop
     BEGIN_MACHINE {
 
@@ -2218,7 +2616,7 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
             SEXP sym = readConst(readImmediate());
             advanceImmediate();
             assert(!LazyEnvironment::check(env));
-            SEXP res = Rf_findVar(sym, ENCLOS(env));
+            SEXP res = cachedGetSuperVar(c, sym, ENCLOS(env));
 
             if (res == R_UnboundValue) {
                 Rf_error("object '%s' not found", CHAR(PRINTNAME(sym)));
@@ -2301,7 +2699,7 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
                 superEnv = le->getParent();
             else
                 superEnv = ENCLOS(env);
-            rirSetVarWrapper(sym, val, superEnv);
+            rirSetVarWrapper(sym, val, superEnv, c);
             NEXT();
         }
 
@@ -2544,7 +2942,85 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
         INSTRUCTION(push_) {
             SEXP res = readConst(readImmediate());
             advanceImmediate();
-            ostack_push(res);
+#ifndef TOS_CACHING
+            // The following arithmetic instruction was already quickened for
+            // the type of this constant, fuse the two. With TOS_CACHING the
+            // cached dispatch executes the binop directly anyway.
+            if (canFuseWithPush(res, *pc))
+                *(pc - 1 - sizeof(Immediate)) = Opcode::push_binop_;
+#endif
+            NEXT_CACHED(res);
+        }
+
+        INSTRUCTION(push_binop_) {
+            SEXP constant = readConst(readImmediate());
+            advanceImmediate();
+            ostack_push(constant);
+            if (!canFuseWithPush(constant, *pc)) {
+                // The binop got dequickened, split again
+                *(pc - 1 - sizeof(Immediate)) = Opcode::push_;
+                NEXT();
+            }
+            // Execute the quickened binop directly, afterwards `pc - 1`
+            // points to it, as expected by the source lookup for warnings.
+            switch (*pc++) {
+            case Opcode::add_int_:
+                QUICK_INT_ARITH(add_, R_integer_plus);
+                break;
+            case Opcode::sub_int_:
+                QUICK_INT_ARITH(sub_, R_integer_minus);
+                break;
+            case Opcode::mul_int_:
+                QUICK_INT_ARITH(mul_, R_integer_times);
+                break;
+            case Opcode::add_real_:
+                QUICK_REAL_ARITH(add_, +);
+                break;
+            case Opcode::sub_real_:
+                QUICK_REAL_ARITH(sub_, -);
+                break;
+            case Opcode::mul_real_:
+                QUICK_REAL_ARITH(mul_, *);
+                break;
+            case Opcode::eq_int_:
+                QUICK_RELOP(eq_, INTSXP, INTEGER, NA_INTEGER, ==);
+                break;
+            case Opcode::ne_int_:
+                QUICK_RELOP(ne_, INTSXP, INTEGER, NA_INTEGER, !=);
+                break;
+            case Opcode::lt_int_:
+                QUICK_RELOP(lt_, INTSXP, INTEGER, NA_INTEGER, <);
+                break;
+            case Opcode::le_int_:
+                QUICK_RELOP(le_, INTSXP, INTEGER, NA_INTEGER, <=);
+                break;
+            case Opcode::gt_int_:
+                QUICK_RELOP(gt_, INTSXP, INTEGER, NA_INTEGER, >);
+                break;
+            case Opcode::ge_int_:
+                QUICK_RELOP(ge_, INTSXP, INTEGER, NA_INTEGER, >=);
+                break;
+            case Opcode::eq_real_:
+                QUICK_RELOP(eq_, REALSXP, REAL, NA_REAL, ==);
+                break;
+            case Opcode::ne_real_:
+                QUICK_RELOP(ne_, REALSXP, REAL, NA_REAL, !=);
+                break;
+            case Opcode::lt_real_:
+                QUICK_RELOP(lt_, REALSXP, REAL, NA_REAL, <);
+                break;
+            case Opcode::le_real_:
+                QUICK_RELOP(le_, REALSXP, REAL, NA_REAL, <=);
+                break;
+            case Opcode::gt_real_:
+                QUICK_RELOP(gt_, REALSXP, REAL, NA_REAL, >);
+                break;
+            case Opcode::ge_real_:
+                QUICK_RELOP(ge_, REALSXP, REAL, NA_REAL, >=);
+                break;
+            default:
+                assert(false);
+            }
             NEXT();
         }
 
@@ -2677,6 +3153,7 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
             SEXP lhs = ostack_at(1);
             SEXP rhs = ostack_at(0);
             SEXP res = nullptr;
+            QUICKEN_BINOP(add_);
             DO_BINOP(+, Binop::PLUSOP);
             NEXT();
         }
@@ -2685,6 +3162,7 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
             SEXP lhs = ostack_at(1);
             SEXP rhs = ostack_at(0);
             SEXP res = nullptr;
+            QUICKEN_BINOP(sub_);
             DO_BINOP(-, Binop::MINUSOP);
             NEXT();
         }
@@ -2693,6 +3171,7 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
             SEXP lhs = ostack_at(1);
             SEXP rhs = ostack_at(0);
             SEXP res = nullptr;
+            QUICKEN_BINOP(mul_);
             DO_BINOP(*, Binop::TIMESOP);
             NEXT();
         }
@@ -2858,6 +3337,7 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
             SEXP lhs = ostack_at(1);
             SEXP rhs = ostack_at(0);
             SEXP res = nullptr;
+            QUICKEN_BINOP(eq_);
             DO_RELOP(==);
             ostack_popn(2);
             ostack_push(res);
@@ -2869,6 +3349,7 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
             SEXP lhs = ostack_at(1);
             SEXP rhs = ostack_at(0);
             SEXP res = nullptr;
+            QUICKEN_BINOP(ne_);
             DO_RELOP(!=);
             ostack_popn(2);
             ostack_push(res);
@@ -2879,6 +3360,7 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
             SEXP lhs = ostack_at(1);
             SEXP rhs = ostack_at(0);
             SEXP res = nullptr;
+            QUICKEN_BINOP(lt_);
             DO_RELOP(<);
             ostack_popn(2);
             ostack_push(res);
@@ -2889,6 +3371,7 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
             SEXP lhs = ostack_at(1);
             SEXP rhs = ostack_at(0);
             SEXP res = nullptr;
+            QUICKEN_BINOP(le_);
             DO_RELOP(<=);
             ostack_popn(2);
             ostack_push(res);
@@ -2899,6 +3382,7 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
             SEXP lhs = ostack_at(1);
             SEXP rhs = ostack_at(0);
             SEXP res = nullptr;
+            QUICKEN_BINOP(gt_);
             DO_RELOP(>);
             ostack_popn(2);
             ostack_push(res);
@@ -2909,6 +3393,7 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
             SEXP lhs = ostack_at(1);
             SEXP rhs = ostack_at(0);
             SEXP res = nullptr;
+            QUICKEN_BINOP(ge_);
             DO_RELOP(>=);
             ostack_popn(2);
             ostack_push(res);
@@ -3887,6 +4372,190 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
 
         INSTRUCTION(ret_) { goto eval_done; }
 
+        INSTRUCTION(add_int_) {
+            QUICK_INT_ARITH(add_, R_integer_plus);
+        }
+
+        INSTRUCTION(sub_int_) {
+            QUICK_INT_ARITH(sub_, R_integer_minus);
+        }
+
+        INSTRUCTION(mul_int_) {
+            QUICK_INT_ARITH(mul_, R_integer_times);
+        }
+
+        INSTRUCTION(add_real_) {
+            QUICK_REAL_ARITH(add_, +);
+        }
+
+        INSTRUCTION(sub_real_) {
+            QUICK_REAL_ARITH(sub_, -);
+        }
+
+        INSTRUCTION(mul_real_) {
+            QUICK_REAL_ARITH(mul_, *);
+        }
+
+        INSTRUCTION(eq_int_) {
+            QUICK_RELOP(eq_, INTSXP, INTEGER, NA_INTEGER, ==);
+        }
+
+        INSTRUCTION(eq_real_) {
+            QUICK_RELOP(eq_, REALSXP, REAL, NA_REAL, ==);
+        }
+
+        INSTRUCTION(ne_int_) {
+            QUICK_RELOP(ne_, INTSXP, INTEGER, NA_INTEGER, !=);
+        }
+
+        INSTRUCTION(ne_real_) {
+            QUICK_RELOP(ne_, REALSXP, REAL, NA_REAL, !=);
+        }
+
+        INSTRUCTION(lt_int_) {
+            QUICK_RELOP(lt_, INTSXP, INTEGER, NA_INTEGER, <);
+        }
+
+        INSTRUCTION(lt_real_) {
+            QUICK_RELOP(lt_, REALSXP, REAL, NA_REAL, <);
+        }
+
+        INSTRUCTION(le_int_) {
+            QUICK_RELOP(le_, INTSXP, INTEGER, NA_INTEGER, <=);
+        }
+
+        INSTRUCTION(le_real_) {
+            QUICK_RELOP(le_, REALSXP, REAL, NA_REAL, <=);
+        }
+
+        INSTRUCTION(gt_int_) {
+            QUICK_RELOP(gt_, INTSXP, INTEGER, NA_INTEGER, >);
+        }
+
+        INSTRUCTION(gt_real_) {
+            QUICK_RELOP(gt_, REALSXP, REAL, NA_REAL, >);
+        }
+
+        INSTRUCTION(ge_int_) {
+            QUICK_RELOP(ge_, INTSXP, INTEGER, NA_INTEGER, >=);
+        }
+
+        INSTRUCTION(ge_real_) {
+            QUICK_RELOP(ge_, REALSXP, REAL, NA_REAL, >=);
+        }
+
+#ifdef TOS_CACHING
+        // Dispatch with the top of stack cached in `tos`. Instructions that
+        // can consume it without it being on the stack are handled here,
+        // everything else gets `tos` spilled and runs normally. The quick
+        // binops leave their result cached again, so e.g. `i < n` followed by
+        // a branch, or `x + 1L`, never touch the stack for intermediate values.
+        tosCached : {
+            switch (*pc) {
+            case Opcode::brtrue_:
+            case Opcode::brfalse_: {
+                SEXP expected = advanceOpcode() == Opcode::brtrue_
+                                    ? R_TrueValue
+                                    : R_FalseValue;
+                JumpOffset offset = readJumpOffset();
+                advanceJump();
+                if (tos == expected) {
+                    checkUserInterrupt();
+                    pc += offset;
+                }
+                PC_BOUNDSCHECK(pc, c);
+                NEXT();
+            }
+            case Opcode::pop_:
+                advanceOpcode();
+                NEXT();
+            case Opcode::visible_:
+                advanceOpcode();
+                R_Visible = TRUE;
+                goto tosCached;
+            case Opcode::invisible_:
+                advanceOpcode();
+                R_Visible = FALSE;
+                goto tosCached;
+            case Opcode::add_int_:
+                advanceOpcode();
+                CACHED_INT_ARITH(R_integer_plus);
+                break;
+            case Opcode::sub_int_:
+                advanceOpcode();
+                CACHED_INT_ARITH(R_integer_minus);
+                break;
+            case Opcode::mul_int_:
+                advanceOpcode();
+                CACHED_INT_ARITH(R_integer_times);
+                break;
+            case Opcode::add_real_:
+                advanceOpcode();
+                CACHED_REAL_ARITH(+);
+                break;
+            case Opcode::sub_real_:
+                advanceOpcode();
+                CACHED_REAL_ARITH(-);
+                break;
+            case Opcode::mul_real_:
+                advanceOpcode();
+                CACHED_REAL_ARITH(*);
+                break;
+            case Opcode::eq_int_:
+                advanceOpcode();
+                CACHED_RELOP(INTSXP, INTEGER, NA_INTEGER, ==);
+                break;
+            case Opcode::eq_real_:
+                advanceOpcode();
+                CACHED_RELOP(REALSXP, REAL, NA_REAL, ==);
+                break;
+            case Opcode::ne_int_:
+                advanceOpcode();
+                CACHED_RELOP(INTSXP, INTEGER, NA_INTEGER, !=);
+                break;
+            case Opcode::ne_real_:
+                advanceOpcode();
+                CACHED_RELOP(REALSXP, REAL, NA_REAL, !=);
+                break;
+            case Opcode::lt_int_:
+                advanceOpcode();
+                CACHED_RELOP(INTSXP, INTEGER, NA_INTEGER, <);
+                break;
+            case Opcode::lt_real_:
+                advanceOpcode();
+                CACHED_RELOP(REALSXP, REAL, NA_REAL, <);
+                break;
+            case Opcode::le_int_:
+                advanceOpcode();
+                CACHED_RELOP(INTSXP, INTEGER, NA_INTEGER, <=);
+                break;
+            case Opcode::le_real_:
+                advanceOpcode();
+                CACHED_RELOP(REALSXP, REAL, NA_REAL, <=);
+                break;
+            case Opcode::gt_int_:
+                advanceOpcode();
+                CACHED_RELOP(INTSXP, INTEGER, NA_INTEGER, >);
+                break;
+            case Opcode::gt_real_:
+                advanceOpcode();
+                CACHED_RELOP(REALSXP, REAL, NA_REAL, >);
+                break;
+            case Opcode::ge_int_:
+                advanceOpcode();
+                CACHED_RELOP(INTSXP, INTEGER, NA_INTEGER, >=);
+                break;
+            case Opcode::ge_real_:
+                advanceOpcode();
+                CACHED_RELOP(REALSXP, REAL, NA_REAL, >=);
+                break;
+            default:
+                ostack_push(tos);
+                NEXT();
+            }
+        }
+#endif
+
         INSTRUCTION(int3_) {
             asm("int3");
             NEXT();
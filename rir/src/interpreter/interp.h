@@ -128,6 +128,9 @@ inline Function* dispatch(const CallContext& call, DispatchTable* vt) {
 }
 
 void inferCurrentContext(CallContext& call, size_t formalNargs);
+// Whether all args with constant value feedback have that value, optionally
+// recording the values of this call first
+bool matchConstantArgs(const CallContext& call, bool record);
 SEXP getTrivialPromValue(SEXP sym, SEXP env);
 
 SEXP doCall(CallContext& call, bool popArgs = false);
@@ -0,0 +1,67 @@
+#include "opcode_stats.h"
+
+#ifdef RIR_OPCODE_STATS
+
+#include "R/Funtab.h"
+#include "compiler/native/builtins.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+namespace rir {
+
+size_t OpcodeStats::opcodes[NumOpcodes];
+size_t OpcodeStats::pairs[NumOpcodes][NumOpcodes];
+size_t OpcodeStats::fastPathHits[MaxBuiltins];
+size_t OpcodeStats::fastPathMisses[MaxBuiltins];
+size_t OpcodeStats::nativeBuiltins[MaxNativeBuiltins];
+Opcode OpcodeStats::last = Opcode::nop_;
+
+void OpcodeStats::dump(std::ostream& out) {
+    out << "kind,name,count\n";
+    for (size_t i = 0; i < NumOpcodes; ++i)
+        if (opcodes[i])
+            out << "opcode," << BC::name((Opcode)i) << "," << opcodes[i]
+                << "\n";
+    for (size_t i = 0; i < NumOpcodes; ++i)
+        for (size_t j = 0; j < NumOpcodes; ++j)
+            if (pairs[i][j])
+                out << "pair," << BC::name((Opcode)i) << " "
+                    << BC::name((Opcode)j) << "," << pairs[i][j] << "\n";
+    for (size_t i = 0; i < MaxBuiltins; ++i) {
+        if (fastPathHits[i])
+            out << "fastpath_hit," << getBuiltinName(i) << ","
+                << fastPathHits[i] << "\n";
+        if (fastPathMisses[i])
+            out << "fastpath_miss," << getBuiltinName(i) << ","
+                << fastPathMisses[i] << "\n";
+    }
+    pir::NativeBuiltins::eachBuiltin([&](const pir::NativeBuiltin& b) {
+        auto i = &b - &pir::NativeBuiltins::get(pir::NativeBuiltins::Id::FIRST);
+        if (nativeBuiltins[i])
+            out << "native," << b.name << "," << nativeBuiltins[i] << "\n";
+    });
+}
+
+static void dumpAtExit() {
+    auto file = getenv("RIR_OPCODE_STATS_FILE");
+    if (file) {
+        std::ofstream fs(file);
+        if (fs) {
+            OpcodeStats::dump(fs);
+            return;
+        }
+        std::cerr << "ERROR: Can't open '" << file
+                  << "'. Writing to std::cerr.\n";
+    }
+    OpcodeStats::dump(std::cerr);
+}
+
+// Runs before the static destructors of everything initialized so far, in
+// particular the native builtins
+void OpcodeStats::initialize() { std::atexit(dumpAtExit); }
+
+} // namespace rir
+
+#endif
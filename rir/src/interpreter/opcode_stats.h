@@ -0,0 +1,64 @@
+#ifndef RIR_OPCODE_STATS_H
+#define RIR_OPCODE_STATS_H
+
+/*
+ * Instrumentation build mode (cmake -DRIR_OPCODE_STATS=ON). Counts executed
+ * opcodes and pairs of consecutive opcodes (candidates for
+ * superinstructions), hits and misses of the fast paths for builtins and
+ * specials per builtin, and calls to native builtins. At exit the counts are
+ * written as csv with the columns kind,name,count to the file given in
+ * RIR_OPCODE_STATS_FILE, or to stderr.
+ *
+ * Pairs are counted across calls and returns, i.e. they follow the execution
+ * and not the code layout.
+ */
+#ifdef RIR_OPCODE_STATS
+
+#include "R/r.h"
+#include "bc/BC_inc.h"
+
+#include <cstddef>
+#include <ostream>
+
+namespace rir {
+
+struct OpcodeStats {
+    static constexpr size_t NumOpcodes = static_cast<size_t>(Opcode::num_of);
+    // Upper bound for the size of R_FunTab
+    static constexpr size_t MaxBuiltins = 1024;
+    // NativeBuiltins::Id is a uint8_t
+    static constexpr size_t MaxNativeBuiltins = 256;
+
+    static size_t opcodes[NumOpcodes];
+    static size_t pairs[NumOpcodes][NumOpcodes];
+    static size_t fastPathHits[MaxBuiltins];
+    static size_t fastPathMisses[MaxBuiltins];
+    static size_t nativeBuiltins[MaxNativeBuiltins];
+
+    static Opcode dispatch(Opcode op) {
+        opcodes[static_cast<size_t>(op)]++;
+        pairs[static_cast<size_t>(last)][static_cast<size_t>(op)]++;
+        last = op;
+        return op;
+    }
+
+    static void fastPath(int builtin, bool hit) {
+        if (builtin >= 0 && (size_t)builtin < MaxBuiltins)
+            (hit ? fastPathHits : fastPathMisses)[builtin]++;
+    }
+
+    static void initialize();
+    static void dump(std::ostream& out);
+
+  private:
+    static Opcode last;
+};
+
+} // namespace rir
+
+#define OPCODE_STATS(stmt) stmt
+#else
+#define OPCODE_STATS(stmt)
+#endif
+
+#endif
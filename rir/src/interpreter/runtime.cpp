@@ -1,5 +1,6 @@
 #include "api.h"
 #include "interp.h"
+#include "opcode_stats.h"
 #include "profiler.h"
 
 #include <iomanip>
@@ -31,6 +32,7 @@ void initializeRuntime() {
                          rirDecompile, rirPrint, deserializeRir, serializeRir,
                          materialize);
     RuntimeProfiler::initProfiler();
+    OPCODE_STATS(OpcodeStats::initialize());
 }
 
 InterpreterInstance* globalContext() { return globalContext_; }
@@ -53,8 +53,9 @@ struct Code : public RirRuntimeObject<Code, CODE_MAGIC> {
 
     enum class Kind { Bytecode, Native } kind;
 
-    // extra pool, pir type feedback, arg reordering info
-    static constexpr size_t NumLocals = 4;
+    // extra pool, pir type feedback, arg reordering info, rir function,
+    // native module handle, super binding cache
+    static constexpr size_t NumLocals = 6;
 
     Code(Kind kind, FunctionSEXP fun, SEXP src, unsigned srcIdx,
          unsigned codeSize, unsigned sourceSize, size_t localsCnt,
@@ -72,6 +73,8 @@ struct Code : public RirRuntimeObject<Code, CODE_MAGIC> {
      * 1 : pir type feedback
      * 2 : call argument reordering metadata
      * 3 : rir function
+     * 4 : handle of the JIT module holding the native code (see PirJitLLVM)
+     * 5 : binding cells of super assignments (see superBindingCell)
      */
     SEXP locals_[NumLocals];
 
@@ -107,6 +110,13 @@ struct Code : public RirRuntimeObject<Code, CODE_MAGIC> {
         return lazyCompile();
     }
 
+    // The native code is freed once no Code referencing the module handle is
+    // alive anymore
+    void nativeModule(SEXP handle) {
+        assert(kind == Kind::Native);
+        setEntry(4, handle);
+    }
+
     bool isCompiled() const { return kind == Kind::Native && nativeCode_; }
     // For Kind::Native there is an in-between state when the Code is already
     // placed in a Function but its code handle isn't yet filled by the
@@ -208,6 +218,10 @@ struct Code : public RirRuntimeObject<Code, CODE_MAGIC> {
     void arglistOrder(ArglistOrder* data) { setEntry(2, data->container()); }
     SEXP arglistOrderContainer() const { return getEntry(2); }
 
+    // Runtime only, thus not serialized
+    SEXP superBindingCache() const { return getEntry(5); }
+    void superBindingCache(SEXP cache) { setEntry(5, cache); }
+
     size_t size() const {
         return sizeof(Code) + pad4(codeSize) + srcLength * sizeof(SrclistEntry);
     }
@@ -0,0 +1,170 @@
+#include "CodeBudget.h"
+#include "DispatchTable.h"
+#include "compiler/native/pir_jit_llvm.h"
+
+#include <algorithm>
+
+namespace rir {
+
+size_t CodeBudget::budget_ =
+    getenv("PIR_CODE_BUDGET") ? atol(getenv("PIR_CODE_BUDGET")) : 0;
+size_t CodeBudget::evicted_ = 0;
+std::vector<CodeBudget::Entry> CodeBudget::entries;
+SEXP CodeBudget::refs = nullptr;
+
+static size_t codeFootprint(Code* c) {
+    size_t res = XLENGTH(c->container());
+    if (auto fb = c->pirTypeFeedback())
+        res += XLENGTH(fb->container());
+    for (unsigned i = 0; i < c->extraPoolSize; ++i)
+        if (auto p = Code::check(c->getExtraPoolEntry(i)))
+            res += codeFootprint(p);
+    return res;
+}
+
+size_t CodeBudget::footprint(Function* fun) {
+    size_t res = XLENGTH(fun->container()) + codeFootprint(fun->body());
+    for (size_t i = 0; i < fun->nargs(); ++i)
+        if (auto arg = fun->defaultArg(i))
+            res += codeFootprint(arg);
+    return res;
+}
+
+static Function* versionOf(SEXP ref, DispatchTable** dt) {
+    SEXP key = R_WeakRefKey(ref);
+    if (key == R_NilValue)
+        return nullptr;
+    auto fun = Function::unpack(R_ExternalPtrProtected(key));
+    auto table = DispatchTable::unpack(R_ExternalPtrTag(key));
+    for (size_t i = 1; i < table->size(); ++i) {
+        if (table->get(i) == fun) {
+            *dt = table;
+            return fun;
+        }
+    }
+    return nullptr;
+}
+
+void CodeBudget::track(DispatchTable* dt, Function* fun) {
+    if (!refs) {
+        refs = Rf_allocVector(VECSXP, 64);
+        R_PreserveObject(refs);
+    }
+    if (entries.size() == (size_t)XLENGTH(refs)) {
+        refresh(false);
+        if (entries.size() * 2 > (size_t)XLENGTH(refs)) {
+            SEXP grown = Rf_allocVector(VECSXP, XLENGTH(refs) * 2);
+            for (size_t i = 0; i < entries.size(); ++i)
+                SET_VECTOR_ELT(grown, i, VECTOR_ELT(refs, i));
+            R_PreserveObject(grown);
+            R_ReleaseObject(refs);
+            refs = grown;
+        }
+    }
+
+    // Functions can't be weakly referenced. Instead the key is a pointer
+    // which is only reachable from the Function itself.
+    SEXP key = R_MakeExternalPtr(fun, dt->container(), fun->container());
+    PROTECT(key);
+    fun->body()->addExtraPoolEntry(key);
+    SEXP ref = R_MakeWeakRef(key, R_NilValue, R_NilValue, FALSE);
+    SET_VECTOR_ELT(refs, entries.size(), ref);
+    UNPROTECT(1);
+    entries.push_back({ref, footprint(fun), fun->invocationCount(), 0});
+}
+
+void CodeBudget::refresh(bool tick) {
+    size_t live = 0;
+    for (auto& e : entries) {
+        DispatchTable* dt;
+        auto fun = versionOf(e.ref, &dt);
+        if (!fun)
+            continue;
+        if (fun->invocationCount() != e.invocations) {
+            e.invocations = fun->invocationCount();
+            e.idle = 0;
+        } else if (tick) {
+            e.idle++;
+        }
+        SET_VECTOR_ELT(refs, live, e.ref);
+        entries[live++] = e;
+    }
+    for (size_t i = live; i < entries.size(); ++i)
+        SET_VECTOR_ELT(refs, i, R_NilValue);
+    entries.resize(live);
+}
+
+void CodeBudget::enforce(Function* keep) {
+    refresh(true);
+    auto used = usage();
+    if (used <= budget_ || entries.empty())
+        return;
+
+    // Native code is per module, not per version. Assume every version owns
+    // an equal share of it.
+    auto nativeShare = pir::PirJitLLVM::liveNativeCodeBytes() / entries.size();
+
+    std::vector<Entry> order(entries);
+    std::stable_sort(order.begin(), order.end(),
+                     [](const Entry& a, const Entry& b) {
+                         if (a.idle != b.idle)
+                             return a.idle > b.idle;
+                         return a.invocations < b.invocations;
+                     });
+    for (auto& e : order) {
+        if (used <= budget_)
+            break;
+        DispatchTable* dt;
+        auto fun = versionOf(e.ref, &dt);
+        if (!fun || fun == keep || fun->pendingCompilation())
+            continue;
+        // Native callers keep the version in their call target cache and
+        // only dispatch again once it is disabled
+        fun->invalidate();
+        dt->remove(fun->body());
+        evicted_++;
+        used -= std::min(used, e.bytes + nativeShare);
+    }
+    refresh(false);
+}
+
+void CodeBudget::inserted(DispatchTable* dt, Function* fun) {
+    track(dt, fun);
+    if (budget_)
+        enforce(fun);
+}
+
+void CodeBudget::budget(size_t bytes) {
+    budget_ = bytes;
+    if (budget_)
+        enforce(nullptr);
+}
+
+size_t CodeBudget::objectBytes() {
+    refresh(false);
+    size_t res = 0;
+    for (auto& e : entries)
+        res += e.bytes;
+    return res;
+}
+
+size_t CodeBudget::usage() {
+    return pir::PirJitLLVM::liveNativeCodeBytes() + objectBytes();
+}
+
+void CodeBudget::eachVersion(
+    const std::function<void(DispatchTable*, Function*)>& f) {
+    refresh(false);
+    for (auto& e : entries) {
+        DispatchTable* dt;
+        if (auto fun = versionOf(e.ref, &dt))
+            f(dt, fun);
+    }
+}
+
+size_t CodeBudget::versions() {
+    refresh(false);
+    return entries.size();
+}
+
+} // namespace rir
@@ -0,0 +1,75 @@
+#ifndef RIR_CODE_BUDGET_H
+#define RIR_CODE_BUDGET_H
+
+#include "R/r.h"
+
+#include <functional>
+#include <vector>
+
+namespace rir {
+
+struct DispatchTable;
+struct Function;
+
+/*
+ * Process wide budget for optimized code. All optimized versions in
+ * DispatchTables are accounted with the size of their Function, Code and type
+ * feedback objects, plus the native code of all live JIT modules. When a new
+ * version pushes the usage over the budget, the least recently used versions
+ * are removed from their DispatchTables and disabled, such that native call
+ * sites do not keep calling them. The GC frees them (and eventually their
+ * native code) once no running invocation refers to them anymore.
+ *
+ * Recency is approximated by invocation counts: on every insertion we note
+ * for how many insertions a version was not invoked anymore.
+ *
+ * Versions are tracked even without a budget: rir.codeBudget and rir.stats
+ * report on them, and a budget set later must account the versions which
+ * already exist. This costs a weak reference and an extra pool entry per
+ * inserted version, nothing per call. Dead entries are dropped whenever the
+ * reference vector fills up, so it grows with the live versions only.
+ */
+class CodeBudget {
+  public:
+    // Called by the DispatchTable after fun was inserted into dt
+    static void inserted(DispatchTable* dt, Function* fun);
+
+    // In bytes, 0 means unlimited
+    static size_t budget() { return budget_; }
+    static void budget(size_t bytes);
+
+    static size_t usage();
+    static size_t objectBytes();
+    static size_t versions();
+    static size_t evicted() { return evicted_; }
+
+    // Bytes of the runtime objects of an optimized version
+    static size_t footprint(Function* fun);
+    static void
+    eachVersion(const std::function<void(DispatchTable*, Function*)>& f);
+
+  private:
+    struct Entry {
+        // Weak reference to the version, see track
+        SEXP ref;
+        size_t bytes;
+        size_t invocations;
+        size_t idle;
+    };
+
+    static void track(DispatchTable* dt, Function* fun);
+    // Drops versions which are dead or not in their DispatchTable anymore. On
+    // tick the versions not invoked since the last tick age by one.
+    static void refresh(bool tick);
+    static void enforce(Function* keep);
+
+    static size_t budget_;
+    static size_t evicted_;
+    static std::vector<Entry> entries;
+    // Keeps the weak references alive
+    static SEXP refs;
+};
+
+} // namespace rir
+
+#endif
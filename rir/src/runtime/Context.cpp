@@ -34,34 +34,63 @@ std::ostream& operator<<(std::ostream& out, Assumption a) {
     return out;
 }
 
+#define ARGS3(Type)                                                            \
+    TypeAssumption::Arg0Is##Type##_, TypeAssumption::Arg1Is##Type##_,          \
+        TypeAssumption::Arg2Is##Type##_
+#define ARGS6(Type)                                                            \
+    ARGS3(Type), TypeAssumption::Arg3Is##Type##_,                              \
+        TypeAssumption::Arg4Is##Type##_, TypeAssumption::Arg5Is##Type##_
+#define ARGS9(Type)                                                            \
+    ARGS6(Type), TypeAssumption::Arg6Is##Type##_,                              \
+        TypeAssumption::Arg7Is##Type##_, TypeAssumption::Arg8Is##Type##_
+const std::array<TypeAssumption, Context::NUM_TYPED_ARGS>
+    Context::EagerContext = {{ARGS9(Eager)}};
+const std::array<TypeAssumption, Context::NUM_TYPED_ARGS>
+    Context::NotObjContext = {{ARGS9(NotObj)}};
+const std::array<TypeAssumption, Context::NUM_TYPED_ARGS>
+    Context::NonReflContext = {{ARGS9(NonRefl)}};
+const std::array<TypeAssumption, Context::NUM_SCALAR_TYPED_ARGS>
+    Context::SimpleIntContext = {{ARGS6(SimpleInt)}};
+const std::array<TypeAssumption, Context::NUM_SCALAR_TYPED_ARGS>
+    Context::SimpleRealContext = {{ARGS6(SimpleReal)}};
+const std::array<TypeAssumption, Context::NUM_VECTOR_TYPED_ARGS>
+    Context::PlainNumVecContext = {{ARGS3(PlainNumVec)}};
+const std::array<TypeAssumption, Context::NUM_VECTOR_TYPED_ARGS>
+    Context::NAFreeContext = {{ARGS3(NAFree)}};
+const std::array<TypeAssumption, Context::NUM_VECTOR_TYPED_ARGS>
+    Context::PlainListContext = {{ARGS3(PlainList)}};
+#undef ARGS9
+#undef ARGS6
+#undef ARGS3
+
 std::ostream& operator<<(std::ostream& out, TypeAssumption a) {
     switch (a) {
-#define TYPE_ASSUMPTIONS(Type, Msg)                                            \
-    case TypeAssumption::Arg0Is##Type##_:                                      \
-        out << Msg << "0";                                                     \
-        break;                                                                 \
-    case TypeAssumption::Arg1Is##Type##_:                                      \
-        out << Msg << "1";                                                     \
-        break;                                                                 \
-    case TypeAssumption::Arg2Is##Type##_:                                      \
-        out << Msg << "2";                                                     \
-        break;                                                                 \
-    case TypeAssumption::Arg3Is##Type##_:                                      \
-        out << Msg << "3";                                                     \
-        break;                                                                 \
-    case TypeAssumption::Arg4Is##Type##_:                                      \
-        out << Msg << "4";                                                     \
-        break;                                                                 \
-    case TypeAssumption::Arg5Is##Type##_:                                      \
-        out << Msg << "5";                                                     \
-        break;                                                                 \
-
-        TYPE_ASSUMPTIONS(Eager, "Eager");
-        TYPE_ASSUMPTIONS(NotObj, "!Obj");
-        TYPE_ASSUMPTIONS(SimpleInt, "SimpleInt");
-        TYPE_ASSUMPTIONS(SimpleReal, "SimpleReal");
-        TYPE_ASSUMPTIONS(NonRefl, "NonRefl");
+    case TypeAssumption::RestAreEager_:
+        return out << "Eager*";
+    case TypeAssumption::RestAreNonRefl_:
+        return out << "NonRefl*";
+    case TypeAssumption::RestAreNotObj_:
+        return out << "!Obj*";
+    case TypeAssumption::ConstantArgs_:
+        return out << "Const";
+    default:
+        break;
     }
+
+#define TYPE_ASSUMPTIONS(Type, Msg)                                            \
+    for (size_t i = 0; i < Context::Type##Context.size(); ++i)                 \
+        if (Context::Type##Context[i] == a)                                    \
+            return out << Msg << i;
+    TYPE_ASSUMPTIONS(Eager, "Eager");
+    TYPE_ASSUMPTIONS(NotObj, "!Obj");
+    TYPE_ASSUMPTIONS(SimpleInt, "SimpleInt");
+    TYPE_ASSUMPTIONS(SimpleReal, "SimpleReal");
+    TYPE_ASSUMPTIONS(NonRefl, "NonRefl");
+    TYPE_ASSUMPTIONS(PlainNumVec, "NumVec");
+    TYPE_ASSUMPTIONS(NAFree, "!NA");
+    TYPE_ASSUMPTIONS(PlainList, "List");
+#undef TYPE_ASSUMPTIONS
+    assert(false);
     return out;
 }
 
@@ -69,38 +98,70 @@ std::ostream& operator<<(std::ostream& out, const Context& a) {
     if (a.empty()) {
         return out << "<empty Context>";
     }
-    for (auto i = a.flags.begin(); i != a.flags.end(); ++i) {
+    auto flags = a.getFlags();
+    for (auto i = flags.begin(); i != flags.end(); ++i) {
         out << *i;
-        if (i + 1 != a.flags.end())
+        if (i + 1 != flags.end())
             out << ",";
     }
-    if (!a.typeFlags.empty())
+    auto typeFlags = a.getTypeFlags();
+    if (!typeFlags.empty())
         out << ";";
-    for (auto i = a.typeFlags.begin(); i != a.typeFlags.end(); ++i) {
+    for (auto i = typeFlags.begin(); i != typeFlags.end(); ++i) {
         out << *i;
-        if (i + 1 != a.typeFlags.end())
+        if (i + 1 != typeFlags.end())
             out << ",";
     }
-    if (a.missing > 0)
-        out << " miss: " << (int)a.missing;
+    if (a.numMissing() > 0)
+        out << " miss: " << (int)a.numMissing();
     return out;
 }
 
-constexpr std::array<TypeAssumption, Context::NUM_TYPED_ARGS>
-    Context::EagerContext;
-constexpr std::array<TypeAssumption, Context::NUM_TYPED_ARGS>
-    Context::NotObjContext;
-constexpr std::array<TypeAssumption, Context::NUM_TYPED_ARGS>
-    Context::SimpleIntContext;
-constexpr std::array<TypeAssumption, Context::NUM_TYPED_ARGS>
-    Context::SimpleRealContext;
-constexpr std::array<TypeAssumption, Context::NUM_TYPED_ARGS>
-    Context::NonReflContext;
+// Scanning long vectors for NAs on every call does not pay off
+static const R_xlen_t MAX_SIZE_OF_VECTOR_FOR_NA_CHECK = 256;
+
+static bool isNAFree(SEXP vector) {
+    auto n = XLENGTH(vector);
+    if (n > MAX_SIZE_OF_VECTOR_FOR_NA_CHECK)
+        return false;
+    if (TYPEOF(vector) == INTSXP) {
+        auto v = INTEGER(vector);
+        for (R_xlen_t i = 0; i < n; ++i)
+            if (v[i] == NA_INTEGER)
+                return false;
+    } else {
+        auto v = REAL(vector);
+        for (R_xlen_t i = 0; i < n; ++i)
+            if (ISNAN(v[i]))
+                return false;
+    }
+    return true;
+}
+
+void Context::setValueShape(size_t i, SEXP value) {
+    if (IS_SIMPLE_SCALAR(value, REALSXP))
+        setSimpleReal(i);
+    if (IS_SIMPLE_SCALAR(value, INTSXP))
+        setSimpleInt(i);
+    if (i >= NUM_VECTOR_TYPED_ARGS || ATTRIB(value) != R_NilValue)
+        return;
+    if (TYPEOF(value) == INTSXP || TYPEOF(value) == REALSXP) {
+        setPlainNumVec(i);
+        if (isNAFree(value))
+            setNAFree(i);
+    } else if (TYPEOF(value) == VECSXP) {
+        setPlainList(i);
+    }
+}
 
 void Context::setSpecializationLevel(int level) {
     static Flags preserve =
         pir::Compiler::minimalContext | Assumption::StaticallyArgmatched;
 
+    auto flags = getFlags();
+    auto typeFlags = getTypeFlags();
+    auto missing = numMissing();
+
     switch (level) {
     // All Specialization Disabled
     case 0:
@@ -146,6 +207,8 @@ void Context::setSpecializationLevel(int level) {
     default:
         break;
     }
+
+    bits = pack(flags, typeFlags, missing);
 }
 
 unsigned Context::isImproving(Function* f) const {
@@ -181,7 +244,7 @@ unsigned Context::isImproving(const Context& other, bool hasDotsFormals,
     }
 
     auto diff = normalized.toI() & (~other.toI());
-    return 2 * __builtin_popcount(diff);
+    return 2 * __builtin_popcountll(diff);
 }
 
 } // namespace rir
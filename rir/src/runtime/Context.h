@@ -18,6 +18,9 @@ enum class TypeAssumption {
     Arg3IsEager_,
     Arg4IsEager_,
     Arg5IsEager_,
+    Arg6IsEager_,
+    Arg7IsEager_,
+    Arg8IsEager_,
 
     // Arg is not reflective
     Arg0IsNonRefl_,
@@ -26,6 +29,9 @@ enum class TypeAssumption {
     Arg3IsNonRefl_,
     Arg4IsNonRefl_,
     Arg5IsNonRefl_,
+    Arg6IsNonRefl_,
+    Arg7IsNonRefl_,
+    Arg8IsNonRefl_,
 
     // Arg is not an object
     Arg0IsNotObj_,
@@ -34,6 +40,9 @@ enum class TypeAssumption {
     Arg3IsNotObj_,
     Arg4IsNotObj_,
     Arg5IsNotObj_,
+    Arg6IsNotObj_,
+    Arg7IsNotObj_,
+    Arg8IsNotObj_,
 
     // Arg is simple integer scalar
     Arg0IsSimpleInt_,
@@ -51,8 +60,32 @@ enum class TypeAssumption {
     Arg4IsSimpleReal_,
     Arg5IsSimpleReal_,
 
+    // Arg is an integer or real vector without attributes
+    Arg0IsPlainNumVec_,
+    Arg1IsPlainNumVec_,
+    Arg2IsPlainNumVec_,
+
+    // Arg is a plain numeric vector which contains no NA or NaN
+    Arg0IsNAFree_,
+    Arg1IsNAFree_,
+    Arg2IsNAFree_,
+
+    // Arg is a generic vector (list) without attributes
+    Arg0IsPlainList_,
+    Arg1IsPlainList_,
+    Arg2IsPlainList_,
+
+    // Holds for all args from Context::NUM_TYPED_ARGS onwards
+    RestAreEager_,
+    RestAreNonRefl_,
+    RestAreNotObj_,
+
+    // Args with constant value feedback in the baseline (see
+    // Function::constantArg) are passed eagerly and have exactly that value
+    ConstantArgs_,
+
     FIRST = Arg0IsEager_,
-    LAST = Arg5IsSimpleReal_,
+    LAST = ConstantArgs_,
 };
 
 enum class Assumption {
@@ -73,130 +106,183 @@ class ClosureVersion;
 #pragma pack(push)
 #pragma pack(1)
 struct Context {
-    typedef EnumSet<TypeAssumption, uint32_t> TypeFlags;
+    typedef EnumSet<TypeAssumption, uint64_t> TypeFlags;
     typedef EnumSet<Assumption, uint8_t> Flags;
 
     constexpr static size_t MAX_MISSING = 255;
-    // # of args with type assumptions
-    constexpr static size_t NUM_TYPED_ARGS = 6;
-
-    Context() = default;
+    // # of args with individual type assumptions, the rest is summarized
+    constexpr static size_t NUM_TYPED_ARGS = 9;
+    // # of args with SimpleInt and SimpleReal assumptions
+    constexpr static size_t NUM_SCALAR_TYPED_ARGS = 6;
+    // # of args with PlainNumVec, NAFree and PlainList assumptions
+    constexpr static size_t NUM_VECTOR_TYPED_ARGS = 3;
+
+    constexpr Context() {}
     Context(const Context&) noexcept = default;
 
-    explicit constexpr Context(const Flags& flags) : flags(flags) {}
+    explicit constexpr Context(const Flags& flags) : bits(pack(flags, {}, 0)) {}
     constexpr Context(const Flags& flags, uint8_t missing)
-        : flags(flags), missing(missing) {}
+        : bits(pack(flags, {}, missing)) {}
     constexpr Context(const Flags& flags, const TypeFlags& typeFlags,
                       uint8_t missing)
-        : flags(flags), typeFlags(typeFlags), missing(missing) {}
+        : bits(pack(flags, typeFlags, missing)) {}
     explicit Context(void* pos) { memcpy((void*)this, pos, sizeof(*this)); }
     explicit Context(unsigned long val) {
-        // Silence unused field warning
-        (void)unused2;
         memcpy((void*)this, &val, sizeof(*this));
     }
 
     unsigned long toI() const {
         static_assert(sizeof(*this) == sizeof(unsigned long), "");
-        uint64_t m;
-        memcpy(&m, this, sizeof(*this));
-        return m;
+        return bits;
     }
 
-    inline void add(Assumption a) { flags.set(a); }
-    inline void remove(Assumption a) { flags.reset(a); }
-    inline bool includes(Assumption a) const { return flags.includes(a); }
-    inline bool includes(const Flags& a) const { return flags.includes(a); }
-
-#define TYPE_ASSUMPTIONS(Type)                                                 \
-    static constexpr std::array<TypeAssumption, NUM_TYPED_ARGS>                \
-        Type##Context = {                                                      \
-            {TypeAssumption::Arg0Is##Type##_, TypeAssumption::Arg1Is##Type##_, \
-             TypeAssumption::Arg2Is##Type##_, TypeAssumption::Arg3Is##Type##_, \
-             TypeAssumption::Arg4Is##Type##_,                                  \
-             TypeAssumption::Arg5Is##Type##_}};                                \
+    inline void add(Assumption a) { setFlags(getFlags() | a); }
+    inline void remove(Assumption a) {
+        auto f = getFlags();
+        f.reset(a);
+        setFlags(f);
+    }
+    inline bool includes(Assumption a) const { return getFlags().includes(a); }
+    inline bool includes(const Flags& a) const {
+        return getFlags().includes(a);
+    }
+
+    // Args from NUM_TYPED_ARGS onwards share one summary flag for each of
+    // Eager, NonRefl and NotObj, which holds if it holds for all of them.
+    inline bool restIsEager() const {
+        return getTypeFlags().includes(TypeAssumption::RestAreEager_);
+    }
+    inline bool restIsNonRefl() const {
+        return getTypeFlags().includes(TypeAssumption::RestAreNonRefl_);
+    }
+    inline bool restIsNotObj() const {
+        return getTypeFlags().includes(TypeAssumption::RestAreNotObj_);
+    }
+    inline bool restIsSimpleInt() const { return false; }
+    inline bool restIsSimpleReal() const { return false; }
+    inline bool restIsPlainNumVec() const { return false; }
+    inline bool restIsNAFree() const { return false; }
+    inline bool restIsPlainList() const { return false; }
+
+    // To compute the summary, the assumptions of every arg i >= NUM_TYPED_ARGS
+    // are inferred into slot 0 of a scratch context `arg` and added in order.
+    void addRestArg(size_t i, const Context& arg) {
+        assert(i >= NUM_TYPED_ARGS);
+        auto t = getTypeFlags();
+        if (i == NUM_TYPED_ARGS)
+            t = t | TypeAssumption::RestAreEager_ |
+                TypeAssumption::RestAreNonRefl_ |
+                TypeAssumption::RestAreNotObj_;
+        if (!arg.isEager(0))
+            t.reset(TypeAssumption::RestAreEager_);
+        if (!arg.isNonRefl(0))
+            t.reset(TypeAssumption::RestAreNonRefl_);
+        if (!arg.isNotObj(0))
+            t.reset(TypeAssumption::RestAreNotObj_);
+        setTypeFlags(t);
+    }
+
+#define TYPE_ASSUMPTIONS(Type, N, Rest)                                        \
+    static const std::array<TypeAssumption, N> Type##Context;                  \
     inline bool is##Type(size_t i) const {                                     \
-        if (i < NUM_TYPED_ARGS)                                                \
-            if (typeFlags.includes(Type##Context[i]))                          \
-                return true;                                                   \
-        return false;                                                          \
+        if (i < N)                                                             \
+            return getTypeFlags().includes(Type##Context[i]);                  \
+        return restIs##Type();                                                 \
     }                                                                          \
     inline void reset##Type(size_t i) {                                        \
-        if (i < NUM_TYPED_ARGS)                                                \
-            typeFlags.reset(Type##Context[i]);                                 \
+        auto t = getTypeFlags();                                               \
+        if (i < N)                                                             \
+            t.reset(Type##Context[i]);                                         \
+        else                                                                   \
+            t = t & ~TypeFlags(Rest);                                          \
+        setTypeFlags(t);                                                       \
     }                                                                          \
     inline void set##Type(size_t i) {                                          \
-        if (i < NUM_TYPED_ARGS)                                                \
-            typeFlags.set(Type##Context[i]);                                   \
+        if (i < N)                                                             \
+            setTypeFlags(getTypeFlags() | Type##Context[i]);                   \
     }
-    TYPE_ASSUMPTIONS(Eager);
-    TYPE_ASSUMPTIONS(NotObj);
-    TYPE_ASSUMPTIONS(SimpleInt);
-    TYPE_ASSUMPTIONS(SimpleReal);
-    TYPE_ASSUMPTIONS(NonRefl);
+    TYPE_ASSUMPTIONS(Eager, NUM_TYPED_ARGS,
+                     TypeFlags(TypeAssumption::RestAreEager_));
+    TYPE_ASSUMPTIONS(NotObj, NUM_TYPED_ARGS,
+                     TypeFlags(TypeAssumption::RestAreNotObj_));
+    TYPE_ASSUMPTIONS(NonRefl, NUM_TYPED_ARGS,
+                     TypeFlags(TypeAssumption::RestAreNonRefl_));
+    TYPE_ASSUMPTIONS(SimpleInt, NUM_SCALAR_TYPED_ARGS, TypeFlags());
+    TYPE_ASSUMPTIONS(SimpleReal, NUM_SCALAR_TYPED_ARGS, TypeFlags());
+    TYPE_ASSUMPTIONS(PlainNumVec, NUM_VECTOR_TYPED_ARGS, TypeFlags());
+    TYPE_ASSUMPTIONS(NAFree, NUM_VECTOR_TYPED_ARGS, TypeFlags());
+    TYPE_ASSUMPTIONS(PlainList, NUM_VECTOR_TYPED_ARGS, TypeFlags());
 #undef TYPE_ASSUMPTIONS
 
+    // Sets the SimpleInt, SimpleReal and vector shape assumptions which hold
+    // for the (non-promise) value of arg i
+    void setValueShape(size_t i, SEXP value);
+
     static TypeFlags allEagerArgsFlags() {
         Context a;
         for (size_t i = 0; i < NUM_TYPED_ARGS; ++i)
             a.setEager(i);
-        return a.typeFlags;
+        return a.getTypeFlags() | TypeAssumption::RestAreEager_;
     }
     static TypeFlags allNonObjArgsFlags() {
         Context a;
         for (size_t i = 0; i < NUM_TYPED_ARGS; ++i)
             a.setNotObj(i);
-        return a.typeFlags;
+        return a.getTypeFlags() | TypeAssumption::RestAreNotObj_;
     }
 
-    inline uint8_t numMissing() const { return missing; }
+    constexpr uint8_t numMissing() const { return bits >> MissingShift; }
 
     inline void numMissing(long i) {
         assert(i < 255);
-        missing = i;
+        bits = pack(getFlags(), getTypeFlags(), i);
     }
 
-    inline bool empty() const {
-        return flags.empty() && typeFlags.empty() && missing == 0;
-    }
+    inline bool empty() const { return bits == 0; }
 
-    inline size_t count() const { return flags.count() + typeFlags.count(); }
+    inline size_t count() const {
+        return getFlags().count() + getTypeFlags().count();
+    }
 
     constexpr Context operator|(const Flags& other) const {
-        return Context(other | flags, typeFlags, missing);
+        return Context(other | getFlags(), getTypeFlags(), numMissing());
     }
     constexpr Context operator|(const TypeFlags& other) const {
-        return Context(flags, other | typeFlags, missing);
+        return Context(getFlags(), other | getTypeFlags(), numMissing());
     }
     constexpr Context operator|(const Context& other) const {
+        auto missing = numMissing();
+        auto otherMissing = other.numMissing();
 
-        if (missing != other.missing) {
+        if (missing != otherMissing) {
 
             auto minContext = this;
 
-            if (missing > other.missing) {
+            if (missing > otherMissing) {
                 minContext = &other;
             }
 
-            if (minContext->flags.contains(
+            if (minContext->getFlags().contains(
                     Assumption::NoExplicitlyMissingArgs)) {
                 assert(false && "Contexts are not compatible for | operator");
             }
         }
 
-        auto newMissing = other.missing > missing ? other.missing : missing;
-        return Context(other.flags | flags, other.typeFlags | typeFlags,
-                       newMissing);
+        auto newMissing = otherMissing > missing ? otherMissing : missing;
+        return Context(other.getFlags() | getFlags(),
+                       other.getTypeFlags() | getTypeFlags(), newMissing);
     }
     constexpr Context operator&(const Context& other) const {
-        if (missing != other.missing) {
-            auto min = missing > other.missing ? other.missing : missing;
-            return Context(other.flags & flags &
+        auto missing = numMissing();
+        auto otherMissing = other.numMissing();
+        if (missing != otherMissing) {
+            auto min = missing > otherMissing ? otherMissing : missing;
+            return Context(other.getFlags() & getFlags() &
                                ~Flags(Assumption::NoExplicitlyMissingArgs),
-                           other.typeFlags & typeFlags, min);
+                           other.getTypeFlags() & getTypeFlags(), min);
         }
-        return Context(other.flags & flags, other.typeFlags & typeFlags,
-                       missing);
+        return Context(other.getFlags() & getFlags(),
+                       other.getTypeFlags() & getTypeFlags(), missing);
     }
 
     inline bool operator<(const Context& other) const {
@@ -211,40 +297,42 @@ struct Context {
 
         // we need a complete order, smaller is only partial
         // (more assumptions = smaller context)
-        if (flags.count() != other.flags.count())
-            return flags.count() > other.flags.count();
-        if (typeFlags.count() != other.typeFlags.count())
-            return typeFlags.count() > other.typeFlags.count();
-        if (missing != other.missing)
-            return missing > other.missing;
-        if (flags.to_i() != other.flags.to_i())
-            return flags.to_i() > other.flags.to_i();
-        return typeFlags.to_i() > other.typeFlags.to_i();
+        auto flags = getFlags(), otherFlags = other.getFlags();
+        auto typeFlags = getTypeFlags(), otherTypeFlags = other.getTypeFlags();
+        if (flags.count() != otherFlags.count())
+            return flags.count() > otherFlags.count();
+        if (typeFlags.count() != otherTypeFlags.count())
+            return typeFlags.count() > otherTypeFlags.count();
+        if (numMissing() != other.numMissing())
+            return numMissing() > other.numMissing();
+        if (flags.to_i() != otherFlags.to_i())
+            return flags.to_i() > otherFlags.to_i();
+        return typeFlags.to_i() > otherTypeFlags.to_i();
     }
 
     inline bool operator!=(const Context& other) const {
-        return flags != other.flags || typeFlags != other.typeFlags ||
-               missing != other.missing;
+        return bits != other.bits;
     }
 
     inline bool operator==(const Context& other) const {
-        return flags == other.flags && typeFlags == other.typeFlags &&
-               missing == other.missing;
+        return bits == other.bits;
     }
 
     bool smaller(const Context& other) const {
         // argdiff positive = "more than expected", negative = "less than"
-        int argdiff = (int)other.missing - (int)missing;
+        int argdiff = (int)other.numMissing() - (int)numMissing();
 
         if (argdiff > 0 &&
-            other.flags.contains(Assumption::NotTooManyArguments))
+            other.getFlags().contains(Assumption::NotTooManyArguments))
             return false;
         if (argdiff < 0 &&
-            other.flags.contains(Assumption::NoExplicitlyMissingArgs))
+            other.getFlags().contains(Assumption::NoExplicitlyMissingArgs))
             return false;
 
-        return flags.includes(other.flags) &&
-               typeFlags.includes(other.typeFlags);
+        // Both flag sets are included iff all of other's bits are set here.
+        // The missing count is compared above.
+        auto mask = ~((uint64_t)0xff << MissingShift);
+        return (bits & other.bits & mask) == (other.bits & mask);
     }
 
     unsigned isImproving(rir::Function*) const;
@@ -259,41 +347,66 @@ struct Context {
     friend std::ostream& operator<<(std::ostream& out, const Context& a);
 
     void clearExcept(const Flags& filter) {
-        flags = flags & filter;
-        typeFlags.reset();
-        missing = 0;
+        bits = pack(getFlags() & filter, {}, 0);
     }
 
-    void clearTypeFlags() {
-        typeFlags.reset();
-    }
+    void clearTypeFlags() { setTypeFlags({}); }
 
     void clearNargs() {
-        missing = 0;
-        flags.reset(Assumption::NoExplicitlyMissingArgs);
+        remove(Assumption::NoExplicitlyMissingArgs);
+        numMissing(0);
     }
 
     void clearObjFlags() {
         for (size_t i = 0; i < NUM_TYPED_ARGS; ++i)
             resetNotObj(i);
+        resetNotObj(NUM_TYPED_ARGS);
     }
 
     void setSpecializationLevel(int level);
 
     Context operator-(const Context& other) const {
-        return Context(flags & ~other.flags, typeFlags & ~other.typeFlags,
-                       missing - other.missing);
+        return Context(getFlags() & ~other.getFlags(),
+                       getTypeFlags() & ~other.getTypeFlags(),
+                       numMissing() - other.numMissing());
     }
 
-    Flags getFlags() const { return flags; }
+    constexpr Flags getFlags() const {
+        return Flags((uint8_t)(bits >> FlagsShift));
+    }
 
-    TypeFlags getTypeFlags() const { return typeFlags; }
+    constexpr TypeFlags getTypeFlags() const {
+        return TypeFlags(bits & TypeFlagsMask);
+    }
 
   private:
-    Flags flags;
-    TypeFlags typeFlags;
-    uint8_t missing = 0;
-    uint16_t unused2 = 0;
+    // Packed into one word, since contexts are passed around as immediates
+    // and as 64 bit values in native code:
+    //   [0, 52) type flags, [52, 60) # missing args, [60, 64) flags
+    static constexpr unsigned MissingShift = 52;
+    static constexpr unsigned FlagsShift = 60;
+    static constexpr uint64_t TypeFlagsMask = ((uint64_t)1 << MissingShift) - 1;
+    static_assert((size_t)TypeAssumption::LAST < MissingShift,
+                  "Too many type assumptions");
+    static_assert((size_t)Assumption::LAST < 64 - FlagsShift,
+                  "Too many assumptions");
+
+    static constexpr uint64_t pack(const Flags& flags,
+                                   const TypeFlags& typeFlags,
+                                   uint8_t missing) {
+        return ((uint64_t)flags.to_i() << FlagsShift) |
+               ((uint64_t)missing << MissingShift) |
+               (typeFlags.to_i() & TypeFlagsMask);
+    }
+
+    void setFlags(const Flags& flags) {
+        bits = pack(flags, getTypeFlags(), numMissing());
+    }
+    void setTypeFlags(const TypeFlags& typeFlags) {
+        bits = pack(getFlags(), typeFlags, numMissing());
+    }
+
+    uint64_t bits = 0;
 };
 #pragma pack(pop)
 
@@ -310,9 +423,7 @@ namespace std {
 template <>
 struct hash<rir::Context> {
     std::size_t operator()(const rir::Context& v) const {
-        return hash_combine(
-            hash_combine(hash_combine(0, v.flags.to_i()), v.typeFlags.to_i()),
-            v.missing);
+        return hash_combine(0, v.bits);
     }
 };
 } // namespace std
@@ -1,6 +1,7 @@
 #ifndef RIR_DISPATCH_TABLE_H
 #define RIR_DISPATCH_TABLE_H
 
+#include "CodeBudget.h"
 #include "Function.h"
 #include "R/Serialize.h"
 #include "RirRuntimeObject.h"
@@ -133,6 +134,7 @@ struct DispatchTable
                     fun->addDeoptCount(old->deoptCount());
                     setEntry(i, fun->container());
                     assert(get(i) == fun);
+                    CodeBudget::inserted(this, fun);
                 }
                 return;
             }
@@ -153,7 +155,8 @@ struct DispatchTable
             std::cout << "Tried to insert: " << assumptions << "\n";
             Rf_error("dispatch table overflow");
 #endif
-            // Evict one element and retry
+            // Evict one element and retry. Once the evicted version is
+            // collected, its native code is freed as well.
             auto pos = 1 + (Random::singleton()() % (size() - 1));
             size_--;
             while (pos < size()) {
@@ -182,6 +185,7 @@ struct DispatchTable
         }
         assert(contains(fun->context()));
 #endif
+        CodeBudget::inserted(this, fun);
     }
 
     static DispatchTable* create(size_t capacity = 20) {
@@ -13,7 +13,7 @@ Function* Function::deserialize(SEXP refTable, R_inpstream_t inp) {
     Function* fun = new (payload) Function(functionSize, nullptr, {}, sig, as);
     fun->numArgs_ = InInteger(inp);
     fun->info.gc_area_length += fun->numArgs_;
-    for (unsigned i = 0; i < fun->numArgs_ + 1; i++) {
+    for (unsigned i = 0; i < fun->numArgs_ + NUM_PTRS; i++) {
         fun->setEntry(i, R_NilValue);
     }
     PROTECT(store);
@@ -52,6 +52,79 @@ void Function::serialize(SEXP refTable, R_outpstream_t out) const {
     OutInteger(out, flags.to_i());
 }
 
+bool Function::isSpecializableConstant(SEXP value) {
+    switch (TYPEOF(value)) {
+    case LGLSXP:
+    case INTSXP:
+    case REALSXP:
+    case STRSXP:
+        return IS_SIMPLE_SCALAR(value, TYPEOF(value));
+    default:
+        return false;
+    }
+}
+
+bool Function::sameConstant(SEXP a, SEXP b) {
+    if (a == b)
+        return true;
+    if (TYPEOF(a) != TYPEOF(b) || !isSpecializableConstant(b))
+        return false;
+    switch (TYPEOF(a)) {
+    case LGLSXP:
+        return LOGICAL(a)[0] == LOGICAL(b)[0];
+    case INTSXP:
+        return INTEGER(a)[0] == INTEGER(b)[0];
+    case REALSXP:
+        // Bitwise, to tell apart NA from NaN and -0 from 0
+        return memcmp(REAL(a), REAL(b), sizeof(double)) == 0;
+    case STRSXP:
+        return STRING_ELT(a, 0) == STRING_ELT(b, 0);
+    default:
+        assert(false);
+        return false;
+    }
+}
+
+// In the feedback vector, unseen args are R_UnboundValue and args which are
+// not constant are R_MissingArg.
+bool Function::recordArgValue(size_t i, SEXP value) {
+    assert(!isOptimized());
+    if (i >= MAX_CONSTANT_ARGS || i >= numArgs_)
+        return false;
+
+    SEXP feedback = getEntry(1);
+    if (!feedback || feedback == R_NilValue) {
+        size_t n = numArgs_ < MAX_CONSTANT_ARGS ? numArgs_ : MAX_CONSTANT_ARGS;
+        feedback = Rf_allocVector(VECSXP, n);
+        for (size_t j = 0; j < n; ++j)
+            SET_VECTOR_ELT(feedback, j, R_UnboundValue);
+        setEntry(1, feedback);
+    }
+
+    auto seen = VECTOR_ELT(feedback, i);
+    if (seen == R_MissingArg)
+        return false;
+    if (seen == R_UnboundValue) {
+        SET_VECTOR_ELT(feedback, i,
+                       isSpecializableConstant(value) ? value : R_MissingArg);
+        return false;
+    }
+    if (sameConstant(seen, value))
+        return false;
+    SET_VECTOR_ELT(feedback, i, R_MissingArg);
+    return true;
+}
+
+SEXP Function::constantArg(size_t i) const {
+    SEXP feedback = getEntry(1);
+    if (!feedback || feedback == R_NilValue || i >= (size_t)XLENGTH(feedback))
+        return nullptr;
+    auto seen = VECTOR_ELT(feedback, i);
+    if (seen == R_UnboundValue || seen == R_MissingArg)
+        return nullptr;
+    return seen;
+}
+
 void Function::disassemble(std::ostream& out) {
     out << "[sigature] ";
     signature().print(out);
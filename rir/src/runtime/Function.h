@@ -39,7 +39,10 @@ struct Function : public RirRuntimeObject<Function, FUNCTION_MAGIC> {
     friend class FunctionCodeIterator;
     friend class ConstFunctionCodeIterator;
 
-    static constexpr size_t NUM_PTRS = 1;
+    static constexpr size_t NUM_PTRS = 2;
+
+    // # of args for which the baseline records value feedback
+    static constexpr size_t MAX_CONSTANT_ARGS = Context::NUM_TYPED_ARGS;
 
     Function(size_t functionSize, SEXP body_,
              const std::vector<SEXP>& defaultArgs,
@@ -58,6 +61,18 @@ struct Function : public RirRuntimeObject<Function, FUNCTION_MAGIC> {
     Code* body() const { return Code::unpack(getEntry(0)); }
     void body(SEXP body) { setEntry(0, body); }
 
+    /*
+     * Value feedback on the first MAX_CONSTANT_ARGS args, recorded in the
+     * baseline. Only small scalar constants which are passed eagerly are
+     * tracked, every arg goes from unseen to constant and (for good) to not
+     * constant. recordArgValue returns true if the arg stops being constant.
+     */
+    bool recordArgValue(size_t i, SEXP value);
+    // The constant value arg i always had so far, or nullptr
+    SEXP constantArg(size_t i) const;
+    static bool isSpecializableConstant(SEXP value);
+    static bool sameConstant(SEXP a, SEXP b);
+
     static Function* deserialize(SEXP refTable, R_inpstream_t inp);
     void serialize(SEXP refTable, R_outpstream_t out) const;
     void disassemble(std::ostream&);
@@ -172,6 +187,14 @@ struct Function : public RirRuntimeObject<Function, FUNCTION_MAGIC> {
             deoptCount_++;
     }
 
+    // A binding this version speculated on was modified (see
+    // SpeculatedBindings). Unlike a deopt this does not count against the
+    // version.
+    void invalidate() {
+        assert(isOptimized());
+        flags.set(Flag::Deopt);
+    }
+
     void registerDeoptReason(DeoptReason::Reason r) {
         // Deopt reasons are counted in the baseline
         assert(!isOptimized());
@@ -201,7 +224,7 @@ struct Function : public RirRuntimeObject<Function, FUNCTION_MAGIC> {
     Context context_;
 
     // !!! SEXPs traceable by the GC must be declared here !!!
-    // locals contains: body
+    // locals contains: body, arg value feedback
     CodeSEXP locals[NUM_PTRS];
     CodeSEXP defaultArg_[];
 };
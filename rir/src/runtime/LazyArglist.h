@@ -4,6 +4,7 @@
 #include "runtime/ArglistOrder.h"
 #include "runtime/RirRuntimeObject.h"
 
+#include "interpreter/instance.h"
 #include "interpreter/interp_incl.h"
 
 #include <cassert>
@@ -58,14 +59,16 @@ struct LazyArglist : public RirRuntimeObject<LazyArglist, LAZY_ARGS_MAGIC> {
 
     SEXP getArg(size_t i) {
         if (stackArgs) {
-            assert(stackArgs[i].tag == 0);
-            return stackArgs[i].u.sxpval;
+            return ostack_box_cell(const_cast<R_bcstack_t*>(stackArgs + i));
         } else {
             return heapArgs[i];
         }
     }
 
     SEXP createArglist() {
+        if (stackArgs)
+            for (size_t i = 0; i < length; ++i)
+                ostack_box_cell(const_cast<R_bcstack_t*>(stackArgs + i));
         return createLegacyArglist(
             callId, length, stackArgs, stackArgs ? nullptr : heapArgs, nullptr,
             ast, reordering ? ArglistOrder::unpack(reordering) : nullptr, false,
@@ -81,12 +84,11 @@ struct LazyArglist : public RirRuntimeObject<LazyArglist, LAZY_ARGS_MAGIC> {
                            onStack ? 0 : (1 + length)),
           callId(id), length(length), ast(ast), reordering(arglistOrder) {
 #ifdef ENABLE_SLOWASSERT
-        for (size_t i = 0; i < length; ++i) {
-            assert(args[i].tag == 0);
-            assert(args[i].u.sxpval);
-        }
+        for (size_t i = 0; i < length; ++i)
+            assert(args[i].tag != 0 || args[i].u.sxpval);
 #endif
         if (onStack) {
+            // Unboxed args are only boxed if the arglist is actually needed
             stackArgs = args;
         } else {
             stackArgs = nullptr;
@@ -97,7 +99,6 @@ struct LazyArglist : public RirRuntimeObject<LazyArglist, LAZY_ARGS_MAGIC> {
         }
     }
 
-    friend struct LazyArglistOnHeap;
     friend struct LazyArglistOnStack;
 
     const ArglistOrder::CallId callId;
@@ -125,6 +126,26 @@ struct LazyArglistOnStack {
     LazyArglistOnStack(ArglistOrder::CallId id, SEXP arglistOrder,
                        size_t length, const R_bcstack_t* args, SEXP ast)
         : content(id, arglistOrder, length, args, ast, true) {
+        initFakeSEXP();
+        PROTECT(arglistOrder);
+    }
+
+    ~LazyArglistOnStack() { UNPROTECT(1); }
+
+    // Arglists placed in the frame of native code are never destroyed. They
+    // do not protect the order, the calling code keeps it alive.
+    struct InNativeFrame {};
+    LazyArglistOnStack(InNativeFrame, ArglistOrder::CallId id,
+                       SEXP arglistOrder, size_t length,
+                       const R_bcstack_t* args, SEXP ast)
+        : content(id, arglistOrder, length, args, ast, true) {
+        initFakeSEXP();
+    }
+
+    SEXP asSexp() { return (SEXP)this; }
+
+  private:
+    void initFakeSEXP() {
         fakeSEXP.attrib = R_NilValue;
         fakeSEXP.gengc_next_node = R_NilValue;
         fakeSEXP.gengc_prev_node = R_NilValue;
@@ -132,32 +153,14 @@ struct LazyArglistOnStack {
         fakeSEXP.sxpinfo.mark = 1;
         fakeSEXP.sxpinfo.named = NAMEDMAX;
         fakeSEXP.sxpinfo.type = EXTERNALSXP;
-        PROTECT(arglistOrder);
     }
 
-    ~LazyArglistOnStack() { UNPROTECT(1); }
-
-    SEXP asSexp() { return (SEXP)this; }
-
-  private:
     VECTOR_SEXPREC fakeSEXP;
 
   public:
     LazyArglist content;
 };
 
-struct LazyArglistOnHeap {
-  public:
-    static SEXP New(ArglistOrder::CallId id, SEXP arglistOrder, size_t length,
-                    const R_bcstack_t* args, SEXP ast) {
-        SEXP wrapper = Rf_allocVector(
-            EXTERNALSXP, sizeof(LazyArglist) + sizeof(SEXP) * (1 + length));
-        auto la = new (DATAPTR(wrapper))
-            LazyArglist(id, arglistOrder, length, args, ast, false);
-        return la->container();
-    }
-};
-
 } // namespace rir
 
 #endif
@@ -0,0 +1,54 @@
+#include "SpeculatedBindings.h"
+#include "Function.h"
+
+namespace rir {
+
+SEXP SpeculatedBindings::registry = nullptr;
+
+void SpeculatedBindings::record(Function* fun,
+                                const std::unordered_set<SEXP>& syms) {
+    if (syms.empty())
+        return;
+    if (!registry) {
+        registry = R_NewHashedEnv(R_EmptyEnv, Rf_ScalarInteger(0));
+        R_PreserveObject(registry);
+    }
+
+    // Functions can't be weakly referenced. Instead the key is a pointer
+    // which is only reachable from the Function itself.
+    SEXP key = R_MakeExternalPtr(fun, R_NilValue, fun->container());
+    PROTECT(key);
+    fun->body()->addExtraPoolEntry(key);
+    SEXP ref = R_MakeWeakRef(key, R_NilValue, R_NilValue, FALSE);
+    PROTECT(ref);
+    for (auto sym : syms) {
+        SEXP deps = Rf_findVarInFrame(registry, sym);
+        if (deps == R_UnboundValue)
+            deps = R_NilValue;
+        // Drop the references to collected Functions
+        while (deps != R_NilValue && R_WeakRefKey(CAR(deps)) == R_NilValue)
+            deps = CDR(deps);
+        for (SEXP d = deps; d != R_NilValue && CDR(d) != R_NilValue;) {
+            if (R_WeakRefKey(CADR(d)) == R_NilValue)
+                SETCDR(d, CDDR(d));
+            else
+                d = CDR(d);
+        }
+        Rf_defineVar(sym, Rf_cons(ref, deps), registry);
+    }
+    UNPROTECT(2);
+}
+
+void SpeculatedBindings::invalidateSlow(SEXP sym) {
+    SEXP deps = Rf_findVarInFrame(registry, sym);
+    if (deps == R_UnboundValue || deps == R_NilValue)
+        return;
+    for (SEXP d = deps; d != R_NilValue; d = CDR(d)) {
+        SEXP key = R_WeakRefKey(CAR(d));
+        if (key != R_NilValue)
+            Function::unpack(R_ExternalPtrProtected(key))->invalidate();
+    }
+    Rf_defineVar(sym, R_NilValue, registry);
+}
+
+} // namespace rir
@@ -0,0 +1,43 @@
+#ifndef RIR_SPECULATED_BINDINGS_H
+#define RIR_SPECULATED_BINDINGS_H
+
+#include "R/r.h"
+
+#include <unordered_set>
+
+namespace rir {
+
+struct Function;
+
+/*
+ * Registry of the optimized Functions which treat a locked binding in base as
+ * a constant (see SafeBuiltinsList::assumeStableInBaseEnv). Base bindings live
+ * in the symbol itself, thus they are keyed by symbol. When such a binding is
+ * modified, the Functions get disabled in their DispatchTable. Running
+ * invocations continue, the next call dispatches to another version and
+ * eventually recompiles.
+ *
+ * Changing a base binding requires unlocking it first. rir notifies the
+ * registry when its own stores change a base binding, GNU R's assign or $<-
+ * on the base env are not seen.
+ */
+class SpeculatedBindings {
+  public:
+    static void record(Function* fun, const std::unordered_set<SEXP>& syms);
+
+    // Disables all Functions speculating on the base binding of sym
+    static void invalidate(SEXP sym) {
+        if (registry)
+            invalidateSlow(sym);
+    }
+
+  private:
+    static void invalidateSlow(SEXP sym);
+
+    // Hashed env, binding symbols to lists of weak references to Functions
+    static SEXP registry;
+};
+
+} // namespace rir
+
+#endif
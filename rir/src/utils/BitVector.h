@@ -0,0 +1,115 @@
+#ifndef RIR_BITVECTOR_H
+#define RIR_BITVECTOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace rir {
+
+/*
+ * Dense set of small unsigned integers (e.g. BB ids, or values numbered by a
+ * per-Code numbering). Grows on demand; testing an index beyond the current
+ * size yields false. The set operations return whether the receiver changed,
+ * which makes them directly usable as the merge step of a dataflow analysis.
+ */
+class BitVector {
+    typedef uint64_t Word;
+    static constexpr size_t WordBits = sizeof(Word) * 8;
+
+    std::vector<Word> words;
+
+    static size_t wordIdx(size_t i) { return i / WordBits; }
+    static Word bitMask(size_t i) { return (Word)1 << (i % WordBits); }
+
+  public:
+    BitVector() {}
+    explicit BitVector(size_t sz) : words((sz + WordBits - 1) / WordBits, 0) {}
+
+    void reserve(size_t sz) {
+        auto w = (sz + WordBits - 1) / WordBits;
+        if (w > words.size())
+            words.resize(w, 0);
+    }
+
+    // Returns true if the bit was not set before
+    bool set(size_t i) {
+        reserve(i + 1);
+        auto& w = words[wordIdx(i)];
+        auto m = bitMask(i);
+        if (w & m)
+            return false;
+        w |= m;
+        return true;
+    }
+
+    // Returns true if the bit was set before
+    bool reset(size_t i) {
+        if (wordIdx(i) >= words.size())
+            return false;
+        auto& w = words[wordIdx(i)];
+        auto m = bitMask(i);
+        if (!(w & m))
+            return false;
+        w &= ~m;
+        return true;
+    }
+
+    bool test(size_t i) const {
+        return wordIdx(i) < words.size() && (words[wordIdx(i)] & bitMask(i));
+    }
+
+    bool empty() const {
+        for (auto w : words)
+            if (w)
+                return false;
+        return true;
+    }
+
+    // this |= other
+    bool unionWith(const BitVector& other) {
+        reserve(other.words.size() * WordBits);
+        bool changed = false;
+        for (size_t i = 0; i < other.words.size(); ++i) {
+            auto n = words[i] | other.words[i];
+            if (n != words[i]) {
+                words[i] = n;
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    // Index of the first set bit at position >= from, or npos
+    static constexpr size_t npos = (size_t)-1;
+    size_t findNext(size_t from) const {
+        auto wi = wordIdx(from);
+        if (wi >= words.size())
+            return npos;
+        Word w = words[wi] & (~(Word)0 << (from % WordBits));
+        while (true) {
+            if (w)
+                return wi * WordBits + __builtin_ctzll(w);
+            if (++wi == words.size())
+                return npos;
+            w = words[wi];
+        }
+    }
+    size_t findFirst() const { return findNext(0); }
+
+    template <typename F>
+    void forEach(F f) const {
+        for (size_t wi = 0; wi < words.size(); ++wi) {
+            auto w = words[wi];
+            while (w) {
+                auto bit = __builtin_ctzll(w);
+                f(wi * WordBits + bit);
+                w &= w - 1;
+            }
+        }
+    }
+};
+
+} // namespace rir
+
+#endif
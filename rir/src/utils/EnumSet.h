@@ -36,8 +36,8 @@ class EnumSet {
     static constexpr Store AnyI() { return static_cast<Store>(Any()); }
 
     static constexpr EnumSet Any() {
-        return EnumSet(((1 << ((Store)(Element::LAST) + 1)) - 1) &
-                       ~((1 << (Store)Element::FIRST) - 1));
+        return EnumSet((((Store)1 << ((Store)(Element::LAST) + 1)) - 1) &
+                       ~(((Store)1 << (Store)Element::FIRST) - 1));
     }
 
     constexpr EnumSet() {}
@@ -129,7 +129,7 @@ class EnumSet {
 
     inline constexpr bool empty() const { return set_ == 0; }
 
-    inline std::size_t count() const { return __builtin_popcount(set_); }
+    inline std::size_t count() const { return __builtin_popcountll(set_); }
 
     struct Iterator {
       private:
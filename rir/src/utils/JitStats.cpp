@@ -0,0 +1,37 @@
+#include "utils/JitStats.h"
+
+#include <cassert>
+
+namespace rir {
+
+size_t JitStats::compilations = 0;
+size_t JitStats::compilationsFailed = 0;
+double JitStats::compileTime = 0;
+size_t JitStats::deopts[NumDeoptReasons] = {};
+size_t JitStats::osrEntries = 0;
+size_t JitStats::deoptlessHits = 0;
+size_t JitStats::bindingCacheHits = 0;
+size_t JitStats::bindingCacheMisses = 0;
+
+const char* JitStats::deoptReasonName(size_t reason) {
+    switch ((DeoptReason::Reason)reason) {
+    case DeoptReason::Typecheck:
+        return "Typecheck";
+    case DeoptReason::DeadCall:
+        return "DeadCall";
+    case DeoptReason::CallTarget:
+        return "CallTarget";
+    case DeoptReason::ForceAndCall:
+        return "ForceAndCall";
+    case DeoptReason::EnvStubMaterialized:
+        return "EnvStubMaterialized";
+    case DeoptReason::DeadBranchReached:
+        return "DeadBranchReached";
+    case DeoptReason::Unknown:
+        return "Unknown";
+    }
+    assert(false);
+    return "";
+}
+
+} // namespace rir
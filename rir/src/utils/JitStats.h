@@ -0,0 +1,36 @@
+#ifndef RIR_JIT_STATS_H
+#define RIR_JIT_STATS_H
+
+#include "runtime/TypeFeedback.h"
+
+#include <stddef.h>
+
+namespace rir {
+
+// Process wide counters of the JIT. Unlike Measuring they are always
+// collected, rir.stats() reports them.
+struct JitStats {
+    static constexpr size_t NumDeoptReasons =
+        DeoptReason::DeadBranchReached + 1;
+
+    // Optimizations of closures, not counting OSR and deoptless continuations
+    static size_t compilations;
+    static size_t compilationsFailed;
+    static double compileTime; // in seconds
+
+    static size_t deopts[NumDeoptReasons];
+    static size_t osrEntries;
+    static size_t deoptlessHits;
+
+    // Of the interpreter only, native code does not count its binding
+    // caches. Only counted in RIR_OPCODE_STATS builds, since the lookup
+    // (getCellFromCache) is on the hottest path of the interpreter.
+    static size_t bindingCacheHits;
+    static size_t bindingCacheMisses;
+
+    static const char* deoptReasonName(size_t reason);
+};
+
+} // namespace rir
+
+#endif
@@ -24,6 +24,11 @@ struct MeasuringImpl {
     };
     std::unordered_map<std::string, Timer> timers;
     std::unordered_map<std::string, size_t> events;
+    struct Gauge {
+        size_t current = 0;
+        size_t peak = 0;
+    };
+    std::unordered_map<std::string, Gauge> gauges;
     std::chrono::time_point<std::chrono::high_resolution_clock> start;
     std::chrono::time_point<std::chrono::high_resolution_clock> end;
     size_t threshold = 0;
@@ -120,6 +125,17 @@ struct MeasuringImpl {
             }
         }
 
+        if (!gauges.empty()) {
+            std::map<std::string, Gauge> orderedGauges(gauges.begin(),
+                                                       gauges.end());
+            out << "\n  Gauges (current / peak):\n";
+            for (auto& g : orderedGauges) {
+                out << "    " << std::setw(width) << g.first << "\t"
+                    << readable(g.second.current) << " / "
+                    << readable(g.second.peak) << "\n";
+            }
+        }
+
         out << std::flush;
     }
 
@@ -193,6 +209,14 @@ void Measuring::countEvent(const std::string& name, size_t n) {
     m->events[name] += n;
 }
 
+void Measuring::setGauge(const std::string& name, size_t value) {
+    m->shouldOutput = true;
+    auto& g = m->gauges[name];
+    g.current = value;
+    if (value > g.peak)
+        g.peak = value;
+}
+
 void Measuring::reset(bool outputOld) {
     if (m)
         m->shouldOutput = outputOld;
@@ -0,0 +1,25 @@
+# Named calls to callees which are not statically argmatched replay the
+# matching of earlier calls. Calls with a different shape must not reuse it.
+f <- function(a, b = 2, ...) c(a, b, length(list(...)))
+g <- function(alpha, beta) alpha - beta
+call <- function(fun, n) {
+    s <- 0
+    for (i in 1:n) s <- s + sum(fun(b = i, a = 1))
+    s
+}
+callDots <- function(fun, ...) fun(...)
+
+for (i in 1:50) {
+    stopifnot(call(f, 3) == 9)
+    stopifnot(identical(f(b = 1, 2, 3, x = 4), c(2, 1, 2)))
+    stopifnot(identical(f(1), c(1, 2, 0)))
+    stopifnot(identical(callDots(f, b = 3, 1), c(1, 3, 0)))
+    stopifnot(g(beta = 1, alpha = 3) == 2)
+    stopifnot(g(be = 1, al = 3) == 2)
+}
+stopifnot(identical(callDots(f, 1, 2, 3), c(1, 2, 1)))
+stopifnot(identical(callDots(f, x = 1, a = 5), c(5, 2, 1)))
+stopifnot(tryCatch(g(gamma = 1, 2), error = function(e) TRUE))
+h <- function(b, a) c(a, b)
+stopifnot(identical(call(function(b, a) a, 2), 2))
+stopifnot(identical(h(b = 1, a = 2), c(2, 1)))
@@ -0,0 +1,37 @@
+# Local variables are accessed through binding cache slots, also in functions
+# with many variables and after the binding was only just created.
+n <- 400
+body <- paste0("{",
+               paste0("v", 1:n, " <- ", 1:n, collapse = "; "), "; ",
+               "s <- 0; for (i in 1:3) s <- s + v1 + v", n, "; ",
+               "v", n, " <- v", n, " + s; ",
+               "c(s, v", n, ", length(ls()))}")
+many <- eval(parse(text = paste0("function() ", body)))
+expected <- c(1203, 1603, n + 2)
+
+fresh <- function(k) {
+    for (i in 1:k) {
+        if (i == k)
+            x <- i
+    }
+    x <- x + 1
+    rm(x)
+    x <- 2
+    x
+}
+
+hashed <- function(e) {
+    evalq({
+        y <- 1
+        for (i in 1:5) y <- y * 2
+        y
+    }, e)
+}
+
+for (i in 1:50) {
+    stopifnot(identical(many(), expected))
+    stopifnot(fresh(3) == 2)
+    stopifnot(hashed(new.env(hash = TRUE)) == 32)
+}
+e <- new.env(hash = TRUE)
+stopifnot(hashed(e) == 32 && get("y", e) == 32)
@@ -0,0 +1,29 @@
+# Builtins get their arguments in an arglist on the C stack. Names, values
+# with attributes and many arguments must come through, objects dispatch.
+f <- function(x, n) {
+    s <- 0
+    for (i in 1:n)
+        s <- s + length(vector(mode = "list", length = i)) + nchar(x)
+    s
+}
+g <- function(a, b) paste(a, b, "c", "d", "e", "f", sep = "-")
+h <- function(x) {
+    attr(x, "k") <- 1
+    x
+}
+length.myclass <- function(x) 42L
+l <- function(x) length(x)
+
+for (i in 1:50) {
+    stopifnot(f("ab", 3) == 12)
+    stopifnot(g("a", "b") == "a-b-c-d-e-f")
+    stopifnot(identical(attr(h(c(a = 1)), "k"), 1))
+    stopifnot(l(structure(1:3, class = "myclass")) == 42L)
+    stopifnot(l(c(a = 1, b = 2)) == 2L)
+}
+y <- 1:3
+z <- h(y)
+stopifnot(is.null(attr(y, "k")))
+stopifnot(identical(attr(z, "k"), 1))
+stopifnot(identical(g(1, 2), "1-2-c-d-e-f"))
+stopifnot(l(list(1, 2)) == 2L)
@@ -0,0 +1,35 @@
+# The rir compiler folds arithmetic on constants and cleans up its bytecode.
+# Results must be as without folding, including integer overflow, NAs and
+# signed zeros.
+f <- function(x) {
+    a <- 1 + 2 * 3
+    b <- -4L + 10L
+    c <- 1 / 3
+    d <- x + (2 - 0.5)
+    if (x > 0) {
+        if (x > 1) e <- 1 else e <- 2
+    } else {
+        e <- 3
+    }
+    c(a, b, c, d, e)
+}
+g <- function() list(2147483647L + 1L, NA_integer_ * 2L, -0,
+                     1 - 1, 0 / 0, NA_real_ + 1, 3L / 2L, -(1:2))
+expected <- list(NA_integer_, NA_integer_, -0, 0, NaN, NA_real_, 1.5,
+                 c(-1L, -2L))
+
+for (i in 1:50) {
+    stopifnot(identical(f(2), c(7, 6, 1 / 3, 3.5, 1)))
+    stopifnot(identical(f(-1), c(7, 6, 1 / 3, 0.5, 3)))
+    stopifnot(suppressWarnings(identical(g(), expected)))
+}
+stopifnot(identical(1 / g()[[3]], -Inf))
+stopifnot(tryCatch(g(), warning = function(w) TRUE))
+
+# The guard on `+` stays in front of the folded constant
+h <- function() 1 + 2
+stopifnot(h() == 3)
+`+` <- function(a, b) "redefined"
+stopifnot(tryCatch(h(), error = function(e) TRUE))
+rm(`+`)
+stopifnot(h() == 3)
@@ -0,0 +1,46 @@
+# Optimized versions are evicted to stay within the code budget. Evicted
+# functions keep working and get optimized again.
+fs <- lapply(1:30, function(k) eval(bquote(function(x) x * 2 + .(k))))
+warm <- function() {
+    for (i in seq_along(fs))
+        for (j in 1:50)
+            stopifnot(fs[[i]](j) == j * 2 + i)
+}
+
+warm()
+before <- rir.codeBudget()
+stopifnot(identical(names(before), c("budget", "usage", "nativeBytes",
+                                     "objectBytes", "versions", "evicted")))
+stopifnot(before[["budget"]] == 0)
+
+rir.setCodeBudget(1)
+after <- rir.codeBudget()
+stopifnot(after[["versions"]] == 0)
+stopifnot(after[["evicted"]] - before[["evicted"]] == before[["versions"]])
+warm()
+
+rir.setCodeBudget(0)
+warm()
+stopifnot(rir.codeBudget()[["budget"]] == 0)
+stopifnot(tryCatch(rir.setCodeBudget(-1), error = function(e) TRUE))
+
+# An evicted callee is disabled, the native call site in its caller dispatches
+# again instead of calling the evicted version.
+callee <- function(x) x + 1
+rir.markFunction(callee, DisableInline = TRUE)
+caller <- function(x, skip) if (skip) x else callee(x)
+for (i in 1:100)
+    stopifnot(caller(i, FALSE) == i + 1)
+rir.setCodeBudget(rir.codeBudget()[["usage"]] * 10)
+# The callee is idle for longer than its caller, thus evicted first
+for (i in 1:100)
+    stopifnot(caller(i, TRUE) == i)
+# Every step evicts the one version idle for longest
+while (any(rir.stats(callee)$optimized))
+    rir.setCodeBudget(rir.codeBudget()[["usage"]] - 1)
+stopifnot(!any(rir.stats(callee)$optimized))
+stopifnot(any(rir.stats(caller)$optimized))
+invocations <- sum(rir.stats(callee)$invocations)
+stopifnot(caller(1, FALSE) == 2)
+stopifnot(sum(rir.stats(callee)$invocations) > invocations)
+rir.setCodeBudget(0)
@@ -0,0 +1,20 @@
+# Versions specialized on constant argument values must only be used while the
+# arguments have those values.
+f <- function(x, na.rm, method) {
+    if (method == "fast")
+        sum(x, na.rm = na.rm)
+    else
+        -sum(x, na.rm = na.rm)
+}
+for (i in 1:30) stopifnot(f(c(1, NA, 2), TRUE, "fast") == 3)
+stopifnot(is.na(f(c(1, NA, 2), FALSE, "fast")))
+stopifnot(f(c(1, NA, 2), TRUE, "slow") == -3)
+m <- "fast"
+stopifnot(f(c(1, NA, 2), TRUE, m) == 3)
+for (i in 1:30) stopifnot(f(c(1, NA, 2), TRUE, "fast") == 3)
+
+g <- function(k) if (k == 2L) "two" else "other"
+for (i in 1:30) stopifnot(g(2L) == "two")
+stopifnot(g(3L) == "other")
+stopifnot(g(2) == "two")
+stopifnot(g(2L) == "two")
@@ -0,0 +1,18 @@
+# Args beyond the individually typed ones are only summarized in the call
+# context. Optimized versions specialized on eager, non-object rest args must
+# still be left when a later call passes a lazy or object argument.
+f <- function(a, b, c, d, e, f, g, h, i, j, k) a + b + c + d + e + f + g + h + i + j + k
+for (n in 1:20) stopifnot(f(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11) == 66)
+
+x <- structure(10, class = "foo")
+Ops.foo <- function(e1, e2) 0
+stopifnot(f(1, 2, 3, 4, 5, 6, 7, 8, 9, x, 11) == 11)
+
+cnt <- 0
+lazy <- function() { cnt <<- cnt + 1; 11 }
+stopifnot(f(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, lazy()) == 66)
+stopifnot(cnt == 1)
+
+g <- function(...) sum(...)
+for (n in 1:20) stopifnot(g(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12) == 78)
+stopifnot(g(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12L) == 78)
@@ -0,0 +1,16 @@
+# Versions specialized on plain numeric vectors, NA free vectors or plain lists
+# must be left when called with vectors of a different shape.
+f <- function(x, y) sum(x) + length(y)
+for (i in 1:20) stopifnot(f(c(1, 2, 3), list(1, 2)) == 8)
+stopifnot(f(c(1L, 2L, 3L), list(1, 2)) == 8)
+stopifnot(is.na(f(c(1, NA, 3), list(1, 2))))
+stopifnot(is.na(f(c(1, NaN, 3), list(1, 2))))
+stopifnot(f(structure(c(1, 2, 3), names = c("a", "b", "c")), list(1)) == 7)
+stopifnot(f(c(1, 2, 3), structure(list(1, 2), class = "foo")) == 8)
+stopifnot(f(c(1, 2, 3), c(1, 2, 3)) == 9)
+stopifnot(f(as.numeric(1:1000), list()) == 500500)
+
+g <- function(x) x[[1]]
+for (i in 1:20) stopifnot(g(list(3, 4)) == 3)
+stopifnot(g(c(5, 6)) == 5)
+stopifnot(is.na(g(list(NA))))
@@ -0,0 +1,48 @@
+# Environments which do not escape are kept in the native frame. They must
+# still be complete when we deoptimize or when they are accessed reflectively.
+f <- function(x, n) {
+    s <- 0
+    for (i in 1:n) s <- s + x
+    s
+}
+g <- function(x, n) {
+    s <- 0
+    for (i in 1:n) {
+        s <- s + x
+        if (i == n)
+            return(c(s, i, length(ls())))
+    }
+}
+h <- function(x, y) {
+    s <- x
+    if (missing(y))
+        return(s)
+    for (i in 1:3) s <- s + y
+    environment()$s
+}
+# The promise is inlined and shares the frame of k. Deoptimizing inside it
+# has to resume both on the same environment.
+k <- function(x) {
+    s <- 1
+    id <- function(v) v
+    r <- id({
+        s <- s + x
+        s * 2
+    })
+    c(s, r)
+}
+
+for (i in 1:50) {
+    stopifnot(identical(k(1), c(2, 4)))
+    stopifnot(f(1, 10) == 10)
+    stopifnot(identical(g(2, 3), c(6, 3, 4)))
+    stopifnot(h(1, 1) == 4)
+}
+stopifnot(identical(f(1L, 10), 10))
+stopifnot(identical(f(1i, 2), 2i))
+stopifnot(identical(g(1L, 2), c(2, 2, 4)))
+stopifnot(tryCatch(g("a", 1), error = function(e) TRUE))
+stopifnot(h(2) == 2)
+stopifnot(h(1, 2L) == 7)
+stopifnot(identical(k(1L), c(2, 4)))
+stopifnot(identical(k(1i), c(2 + 1i, 4 + 2i)))
@@ -0,0 +1,41 @@
+# Accesses indexed by a loop counter may only skip their bounds checks if the
+# whole range of the counter is in bounds.
+sumTo <- function(x, n) {
+    s <- 0
+    for (i in 1:n) s <- s + x[i]
+    s
+}
+sumAll <- function(x) {
+    s <- 0
+    for (i in 1:length(x)) s <- s + x[[i]]
+    s
+}
+sumDown <- function(x) {
+    s <- 0L
+    for (i in length(x):1) s <- s + x[i]
+    s
+}
+double <- function(x) {
+    for (i in 1:length(x)) x[i] <- x[i] * 2
+    x
+}
+grow <- function(x, n) {
+    for (i in 1:n) x[i] <- i
+    x
+}
+
+for (i in 1:50) {
+    stopifnot(sumTo(c(1, 2, 3, 4), 4) == 10)
+    stopifnot(sumAll(c(1, 2, 3)) == 6)
+    stopifnot(sumDown(1:10) == 55L)
+    stopifnot(identical(double(c(1, 2, 3)), c(2, 4, 6)))
+    stopifnot(identical(grow(c(1, 2), 2), c(1, 2)))
+}
+
+# Out of bounds, the checks must still be there
+stopifnot(is.na(sumTo(c(1, 2, 3), 4)))
+stopifnot(identical(grow(c(1, 2), 4), c(1, 2, 3, 4)))
+stopifnot(identical(double(numeric(0)), NA_real_))
+stopifnot(tryCatch(sumAll(numeric(0)), error = function(e) "err") == "err")
+stopifnot(identical(sumDown(integer(0)), integer(0)))
+stopifnot(identical(grow(1:3, 3), 1:3))
@@ -0,0 +1,33 @@
+# Inlined callees which observe their context keep it. Reflection and
+# non-local returns must still see the arguments and reach the context.
+callOf <- function(a, b) sys.call()
+argsOf <- function(a, b) match.call()
+ret <- function(x) {
+    force(if (x > 0) return(x))
+    -x
+}
+
+f <- function(n) {
+    s <- 0
+    for (i in 1:n) s <- s + ret(i - 2)
+    s
+}
+g <- function(n) {
+    r <- NULL
+    for (i in 1:n) r <- callOf(i, n)
+    r
+}
+h <- function(n) {
+    r <- NULL
+    for (i in 1:n) r <- argsOf(b = i, n)
+    r
+}
+
+for (i in 1:50) {
+    stopifnot(f(4) == 4)
+    stopifnot(identical(g(3), quote(callOf(i, n))))
+    stopifnot(identical(h(2), quote(argsOf(a = n, b = i))))
+}
+stopifnot(f(5L) == 7)
+stopifnot(identical(g(1L), quote(callOf(i, n))))
+stopifnot(identical(h(1L), quote(argsOf(a = n, b = i))))
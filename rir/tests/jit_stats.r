@@ -0,0 +1,58 @@
+# rir.stats() reports process wide counters of the jit and the versions of a
+# single function.
+f <- rir.compile(function(x) {
+    s <- 0
+    for (i in 1:x) s <- s + i
+    s
+})
+before <- rir.stats()
+stopifnot(identical(names(before),
+                    c("compilations", "compileTime", "deopts", "osrEntries",
+                      "deoptlessHits", "nativeCode", "dispatchTables",
+                      "bindingCache")))
+stopifnot(identical(names(before$deopts),
+                    c("Unknown", "Typecheck", "DeadCall", "CallTarget",
+                      "ForceAndCall", "EnvStubMaterialized",
+                      "DeadBranchReached")))
+
+for (i in 1:50)
+    stopifnot(f(10) == 55)
+f(10.5)
+
+# The global is not part of the dispatch context, changing its type deopts
+k <- 1L
+d <- rir.compile(function() k + 1L)
+for (i in 1:10)
+    stopifnot(d() == 2L)
+pir.compile(d)
+k <- 1.5
+stopifnot(d() == 2.5)
+
+# Compiled expressions always run in the interpreter
+e <- new.env()
+eval(rir.compile(quote({
+    s <- 0
+    for (i in 1:10) s <- s + i
+})), e)
+stopifnot(e$s == 55)
+
+after <- rir.stats()
+stopifnot(after$compilations[["total"]] > before$compilations[["total"]])
+stopifnot(after$compileTime > before$compileTime)
+stopifnot(sum(after$deopts) > sum(before$deopts))
+# Binding cache lookups are only counted in RIR_OPCODE_STATS builds
+if (is.na(after$bindingCache[["hits"]])) {
+    stopifnot(all(is.na(after$bindingCache)))
+} else {
+    stopifnot(after$bindingCache[["hits"]] > before$bindingCache[["hits"]])
+    stopifnot(after$bindingCache[["hitRate"]] <= 1)
+}
+
+versions <- rir.stats(f)
+stopifnot(identical(names(versions),
+                    c("context", "optimized", "invocations", "deopts",
+                      "disabled", "bytes")))
+stopifnot(!versions$optimized[[1]])
+stopifnot(sum(versions$invocations) >= 51)
+stopifnot(all(versions$bytes > 0))
+stopifnot(tryCatch(rir.stats(1), error = function(e) TRUE))
@@ -0,0 +1,24 @@
+# Loops are copied into a version without their loop invariant assumptions.
+# The original copy must still behave when those do not hold.
+f <- function(x, y, n) {
+    s <- 0
+    for (i in 1:n) s <- s + x * y
+    s
+}
+g <- function(v, n) {
+    last <- 0
+    for (i in 1:n) last <- v[[1]] + i
+    c(last, i)
+}
+
+for (i in 1:50) {
+    stopifnot(f(1, 2, 10) == 20)
+    stopifnot(identical(g(c(1, 2), 3), c(4, 3)))
+}
+stopifnot(identical(f(1L, 2L, 10), 20))
+stopifnot(identical(f(1 + 1i, 1, 2), 2 + 2i))
+stopifnot(f(1, 2, 0) == 4)
+stopifnot(identical(g(list(1L), 2L), c(3L, 2L)))
+stopifnot(identical(g(2L, 1), c(3L, 1L)))
+for (i in 1:10)
+    stopifnot(f(1, 2, 10) == 20)
@@ -0,0 +1,44 @@
+# Compiled callers pass scalar arguments unboxed to compiled callees which
+# expect them. Reflection, deopts and changing targets must still see boxes.
+add <- function(a, b) a + b
+addCall <- function(a, b) {
+    if (a > 100L)
+        return(sys.call())
+    a + b
+}
+addArgs <- function(a, b) {
+    if (a > 100)
+        return(as.list(match.call())[-1])
+    a * b
+}
+
+f <- function(n) {
+    s <- 0L
+    for (i in 1:n) s <- add(s, i)
+    s
+}
+g <- function(n) {
+    s <- 0L
+    for (i in 1:n) s <- addCall(i, s)
+    s
+}
+h <- function(n) {
+    s <- 1
+    for (i in 1:n) {
+        s <- addArgs(s, 1.5)
+        if (is.list(s))
+            break
+    }
+    s
+}
+
+for (i in 1:50) {
+    stopifnot(f(10L) == 55L)
+    stopifnot(g(10L) == 55L)
+    stopifnot(h(3L) == 3.375)
+}
+stopifnot(identical(f(4L), 10L))
+stopifnot(is.call(g(101L)))
+stopifnot(identical(h(20L)$b, 1.5))
+stopifnot(identical(add(1.5, 2L), 3.5))
+stopifnot(identical(f(3L), 6L))
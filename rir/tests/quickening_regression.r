@@ -0,0 +1,28 @@
+# Binops are quickened in place on their first execution, make sure the
+# quickened and fused versions behave like the generic ones and fall back when
+# the operand types change.
+f <- function(a, b) a + b
+for (i in 1:3) stopifnot(f(1L, 2L) == 3L)
+for (i in 1:3) stopifnot(f(1.5, 2) == 3.5)
+stopifnot(f(1L, 2.5) == 3.5)
+stopifnot(identical(f(c(1, 2), 1), c(2, 3)))
+stopifnot(is.na(f(NA_integer_, 1L)))
+r <- withCallingHandlers(f(.Machine$integer.max, 1L),
+                         warning = function(w) invokeRestart("muffleWarning"))
+stopifnot(is.na(r))
+
+g <- function(x) x * 2L - 1L
+for (i in 1:3) stopifnot(g(3L) == 5L)
+stopifnot(g(3) == 5)
+stopifnot(identical(g(1:3), c(1L, 3L, 5L)))
+
+h <- function(x) x < 10
+for (i in 1:3) stopifnot(h(3), !h(30))
+for (i in 1:3) stopifnot(h(3L), !h(30L))
+stopifnot(is.na(h(NA_integer_)))
+stopifnot(identical(h(c(1, 20)), c(TRUE, FALSE)))
+stopifnot(h("1"))
+
+k <- function(x) x == 1L
+for (i in 1:3) stopifnot(k(1L), !k(2L))
+stopifnot(k(1), k(TRUE))
@@ -0,0 +1,27 @@
+# Optimized code treats locked base bindings as constants. When rir code
+# changes such a binding, the versions which folded it get disabled.
+area <- function(r) pi * r * r
+environment(area) <- baseenv()
+setPi <- function(v) pi <<- v
+oldPi <- pi
+
+for (i in 1:50)
+    stopifnot(area(1) == oldPi)
+
+unlockBinding("pi", baseenv())
+setPi(4)
+stopifnot(area(1) == 4)
+for (i in 1:50)
+    stopifnot(area(2) == 16)
+setPi(oldPi)
+lockBinding("pi", baseenv())
+stopifnot(area(1) == oldPi)
+
+for (i in 1:50)
+    stopifnot(area(1) == oldPi)
+unlockBinding("pi", baseenv())
+eval(rir.compile(quote(pi <- 3)), baseenv())
+stopifnot(area(1) == 3)
+setPi(oldPi)
+lockBinding("pi", baseenv())
+stopifnot(area(1) == oldPi)
@@ -0,0 +1,39 @@
+# Common string builtins have fast paths for plain ASCII character vectors.
+# Everything else (NAs, attributes, other encodings) must behave as in R.
+f <- function(xs) {
+    r <- character(0)
+    for (x in xs) {
+        if (startsWith(x, "log:") && !endsWith(x, "!"))
+            r <- c(r, paste0(toupper(substr(x, 5, 7)), nchar(x), "-",
+                             sprintf("%03d|%5.1f|%-4s|%x", nchar(x), 1.25,
+                                     tolower("AB"), 255L)))
+    }
+    r
+}
+expected <- c("ABC8-008|  1.2|ab  |ff", "XY6-006|  1.2|ab  |ff")
+
+for (i in 1:50)
+    stopifnot(identical(f(c("log:abcd", "log:xy", "no", "log:z!")), expected))
+
+stopifnot(identical(paste0("a", 1:3, c("x", NA)), c("a1x", "a2NA", "a3x")))
+stopifnot(identical(paste0("a", 1.5), "a1.5"))
+stopifnot(identical(paste0("a", "b", collapse = "+"), "ab"))
+stopifnot(identical(paste0(character(0), "a"), "a"))
+stopifnot(identical(nchar(NA), 2L))
+stopifnot(identical(nchar(c("abc", NA_character_)), c(3L, NA)))
+stopifnot(identical(nchar(NA_character_, keepNA = FALSE), 2L))
+stopifnot(identical(nchar(c(a = "xy")), c(a = 2L)))
+stopifnot(identical(substr("abcdef", 0, 100), "abcdef"))
+stopifnot(identical(substr(c("abc", NA, "xyz"), 2, 1), c("", NA, "")))
+stopifnot(identical(substr("abc", NA, 2), NA_character_))
+stopifnot(identical(startsWith(c("ab", "b", NA), "a"), c(TRUE, FALSE, NA)))
+stopifnot(identical(endsWith("a", "abc"), FALSE))
+stopifnot(identical(startsWith(character(0), "a"), logical(0)))
+stopifnot(identical(toupper(c(x = "a")), c(x = "A")))
+stopifnot(identical(toupper(c("a1b", NA)), c("A1B", NA)))
+stopifnot(identical(sprintf("%d%%", 10L), "10%"))
+stopifnot(identical(sprintf("%d", 3), "3"))
+stopifnot(identical(sprintf("%s", 1.5), "1.5"))
+stopifnot(identical(sprintf("%5s|%.2e", "ab", 12345.678), "   ab|1.23e+04"))
+stopifnot(identical(sprintf("%d", c(1L, 2L)), c("1", "2")))
+stopifnot(identical(sprintf("%s", NA), "NA"))
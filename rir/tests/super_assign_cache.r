@@ -0,0 +1,43 @@
+# Super assignments and parent frame lookups reuse the binding cells they
+# found before. Removed, shadowed and newly created bindings must be seen.
+counter <- function() {
+    n <- 0
+    list(inc = function(k) {
+        for (i in 1:k) n <<- n + 1
+        n
+    }, get = function() n, env = environment())
+}
+
+for (i in 1:50) {
+    a <- counter()
+    b <- counter()
+    stopifnot(a$inc(3) == 3 && b$inc(2) == 2 && a$inc(1) == 4)
+    stopifnot(a$get() == 4 && b$get() == 2)
+}
+
+c <- counter()
+stopifnot(c$inc(2) == 2)
+rm("n", envir = c$env)
+n <- 10
+stopifnot(c$inc(1) == 11 && n == 11)
+stopifnot(!exists("n", envir = c$env, inherits = FALSE))
+assign("n", 5, envir = c$env)
+stopifnot(c$inc(1) == 6 && n == 11)
+
+setGlobal <- function(v) glob <<- v
+for (i in 1:50) setGlobal(i)
+stopifnot(glob == 50)
+
+outer <- function() {
+    x <- 1
+    mid <- function() {
+        inner <- function() x <<- x + 1
+        inner()
+        x <- 100
+        inner()
+        x
+    }
+    c(mid(), x)
+}
+for (i in 1:50)
+    stopifnot(identical(outer(), c(101, 2)))
@@ -0,0 +1,30 @@
+# Self-recursive calls in tail position become loops, other recursive calls
+# skip the dispatch. Functions observing their frames must keep them.
+sumTo <- function(n, acc) {
+    if (n == 0)
+        return(acc)
+    sumTo(n - 1, acc + n)
+}
+fib <- function(n) {
+    if (n < 2)
+        n
+    else
+        fib(n - 1) + fib(n - 2)
+}
+depth <- function(n) {
+    if (n == 0)
+        return(sys.nframe())
+    depth(n - 1)
+}
+
+for (i in 1:50) {
+    stopifnot(sumTo(100, 0) == 5050)
+    stopifnot(fib(15) == 610)
+    stopifnot(depth(10) - depth(0) == 10)
+}
+stopifnot(identical(sumTo(10L, 0L), 55L))
+stopifnot(identical(sumTo(3, 0.5), 6.5))
+stopifnot(identical(sumTo(2L, 1.5), 4.5))
+stopifnot(fib(20) == 6765)
+stopifnot(identical(fib(10L), 55L))
+stopifnot(depth(20) - depth(0) == 20)